@@ -14,14 +14,40 @@
  *
  * ARM Cortex-M context switch HAL implementation.
  * Uses PendSV for context switching (standard Cortex-M pattern).
+ * PendSV runs at the lowest exception priority, so it also serves as the
+ * interrupt-exit tail where reschedules deferred by ISRs are performed.
  *
  * This is a minimal reference implementation for QEMU cortex-m3.
  */
 
 #include "bedrock/br_hal.h"
 
+#if CONFIG_SMP
+#error "CONFIG_SMP is not supported by the Cortex-M HAL"
+#endif
+
 #define SCB_ICSR    (*(volatile uint32_t *)0xE000ED04)
+#define SCB_SHPR3   (*(volatile uint32_t *)0xE000ED20)
 #define ICSR_PENDSVSET  (1UL << 28)
+#define ICSR_VECTACTIVE 0x1FFUL
+
+#define PENDSV_EXC_NUM  14
+#define SHPR3_PENDSV_LOWEST  (0xFFUL << 16)
+
+/* How pendsv_switch() masks the interrupts that may call the kernel */
+#if CONFIG_ARM_BASEPRI
+#define STR_(x)  #x
+#define STR(x)   STR_(x)
+#define PENDSV_MASK    "movs  r3, #" STR(CONFIG_ARM_BASEPRI_THRESHOLD) " \n" \
+                       "msr   basepri, r3          \n"
+#define PENDSV_UNMASK  "movs  r3, #0               \n" \
+                       "msr   basepri, r3          \n"
+#else
+#define PENDSV_MASK    "cpsid i                    \n"
+#define PENDSV_UNMASK  "cpsie i                    \n"
+#endif
+
+extern void br_sched_isr_exit(void);
 
 /* Global pointers used by PendSV_Handler to perform the actual switch */
 volatile void **br_hal_old_sp_ptr;
@@ -71,17 +97,38 @@ void *br_hal_stack_init(void *stack_top, br_task_entry_t entry, void *arg)
     return (void *)sp;
 }
 
+/* The frame lives in the task's own stack: nothing to give back */
+void br_hal_stack_release(void *sp)
+{
+    (void)sp;
+}
+
 void br_hal_context_switch(void **old_sp, void **new_sp)
 {
     br_hal_old_sp_ptr = (volatile void **)old_sp;
     br_hal_new_sp_ptr = (volatile void **)new_sp;
+
+    /* A switch requested from the PendSV tail itself is picked up
+     * before PendSV returns, no need to pend it again. */
+    if ((SCB_ICSR & ICSR_VECTACTIVE) == PENDSV_EXC_NUM) {
+        return;
+    }
+
     SCB_ICSR = ICSR_PENDSVSET;
     __asm volatile ("dsb" ::: "memory");
     __asm volatile ("isb" ::: "memory");
 }
 
+void br_hal_pend_reschedule(void)
+{
+    SCB_ICSR = ICSR_PENDSVSET;
+}
+
 void br_hal_start_first_task(void *sp)
 {
+    /* PendSV must only tail-chain after every other handler */
+    SCB_SHPR3 |= SHPR3_PENDSV_LOWEST;
+
     /* We need to trigger an exception return to properly enter thread mode with PSP.
      * The cleanest way is to use SVC (supervisor call) exception. */
     __asm volatile (
@@ -169,40 +216,70 @@ void br_hal_check_stack_overflow(br_tcb_t *tcb)
 }
 
 /*
- * PendSV handler (context switch)
+ * PendSV handler (context switch + deferred reschedule)
  *
- * Saves R4-R11 + PSP into the old task's TCB->sp,
- * restores R4-R11 + PSP from the new task's TCB->sp.
+ * pendsv_switch() performs a switch requested by br_hal_context_switch():
+ * it saves R4-R11 + PSP into the old task's TCB->sp and restores R4-R11 +
+ * PSP from the new task's TCB->sp.
  *
  * br_hal_old_sp_ptr -> &old_tcb->sp  (where to store old SP)
- * br_hal_new_sp_ptr -> &new_tcb->sp  (where to load new SP)
+ * br_hal_new_sp_ptr -> &new_tcb->sp  (where to load new SP; NULL = none)
+ *
+ * A pending thread-mode switch is completed first so that the registers
+ * in the CPU belong to current_task again, then br_sched_isr_exit() runs
+ * the reschedule deferred by ISRs (if any), and a switch it requests is
+ * completed before returning to thread mode.  br_sched_isr_exit() is a
+ * normal AAPCS function, so R4-R11 survive the call untouched.
  */
 
-__attribute__((naked))
-void PendSV_Handler(void)
+__attribute__((naked, used))
+static void pendsv_switch(void)
 {
     __asm volatile (
+        PENDSV_MASK
+
+        /* r1 = br_hal_new_sp_ptr; nothing to do if NULL */
+        "ldr   r2, =br_hal_new_sp_ptr \n"
+        "ldr   r1, [r2]             \n"
+        "cbz   r1, 1f               \n"
+        "movs  r3, #0               \n"
+        "str   r3, [r2]             \n"
+
         /* Save current context */
         "mrs   r0, psp              \n"
         "stmdb r0!, {r4-r11}        \n"
 
         /* Store old SP: *br_hal_old_sp_ptr = r0 */
-        "ldr   r1, =br_hal_old_sp_ptr \n"
-        "ldr   r1, [r1]             \n"
-        "str   r0, [r1]             \n"
+        "ldr   r3, =br_hal_old_sp_ptr \n"
+        "ldr   r3, [r3]             \n"
+        "str   r0, [r3]             \n"
 
         /* Load new SP: r0 = *br_hal_new_sp_ptr */
-        "ldr   r1, =br_hal_new_sp_ptr \n"
-        "ldr   r1, [r1]             \n"
         "ldr   r0, [r1]             \n"
 
         /* Restore new context */
         "ldmia r0!, {r4-r11}        \n"
         "msr   psp, r0              \n"
 
+        "1:                         \n"
+        PENDSV_UNMASK
+        "bx    lr                   \n"
+    );
+}
+
+__attribute__((naked))
+void PendSV_Handler(void)
+{
+    __asm volatile (
+        /* Keep EXC_RETURN; r0 pads MSP to 8-byte alignment */
+        "push  {r0, lr}             \n"
+        "bl    pendsv_switch        \n"
+        "bl    br_sched_isr_exit    \n"
+        "bl    pendsv_switch        \n"
+        "pop   {r0, lr}             \n"
+
         /* Return to thread mode using PSP */
-        "ldr   lr, =0xFFFFFFFD      \n"
-        "bx    lr                    \n"
+        "bx    lr                   \n"
     );
 }
 
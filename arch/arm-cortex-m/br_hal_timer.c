@@ -13,8 +13,18 @@
  * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
  *
  * ARM Cortex-M timer HAL implementation.
- * Uses SysTick as the time source and a free-running counter
- * to provide 64-bit microsecond timestamps.
+ *
+ * SysTick runs one-shot: each period is programmed to end at the next
+ * alarm (sleep wakeup, slice end, budget exhaustion), or after the full
+ * 24-bit range when none is pending, so the time base keeps advancing.
+ * Kernel time is the 64-bit count of core cycles itself, so reading it
+ * is an addition and programming an alarm a subtraction.  The counter
+ * is read just before and just after a period is cut short, so the
+ * cycles around the reset are counted and the time base does not drift
+ * with the reprogramming rate.
+ *
+ * The cycle counter for br_cycles_now() is DWT CYCCNT, which also counts
+ * core cycles; ARMv6-M has none and reads the SysTick time base instead.
  *
  * This is a minimal reference implementation suitable for
  * QEMU cortex-m3 emulation.
@@ -27,87 +37,220 @@
 #define SYST_RVR   (*(volatile uint32_t *)0xE000E014)
 #define SYST_CVR   (*(volatile uint32_t *)0xE000E018)
 
+#define SYST_CSR_COUNTFLAG  (1UL << 16)
+
+/* DWT cycle counter, enabled through DEMCR.TRCENA */
+#define DWT_CTRL   (*(volatile uint32_t *)0xE0001000)
+#define DWT_CYCCNT (*(volatile uint32_t *)0xE0001004)
+#define DEMCR      (*(volatile uint32_t *)0xE000EDFC)
+
+#define DWT_CTRL_CYCCNTENA  (1UL << 0)
+#define DEMCR_TRCENA        (1UL << 24)
+
 /* SCB ICSR -- to check active ISR */
 #define SCB_ICSR   (*(volatile uint32_t *)0xE000ED04)
 
-#ifndef BR_HAL_SYS_CLOCK_HZ
-#define BR_HAL_SYS_CLOCK_HZ  16000000UL
+/* SCB SHPR3 -- SysTick priority in bits 31:24 */
+#define SCB_SHPR3  (*(volatile uint32_t *)0xE000ED20)
+
+#if CONFIG_ARM_BASEPRI && defined(__ARM_ARCH_6M__)
+#error "CONFIG_ARM_BASEPRI needs BASEPRI, which ARMv6-M does not have"
 #endif
 
-#define TICKS_PER_US  (BR_HAL_SYS_CLOCK_HZ / 1000000UL)
+/* Period lengths in cycles: the 24-bit counter's full range, and a floor
+ * that keeps an alarm already due from firing inside its own ISR */
+#define MAX_LOAD   0x01000000UL
+#define MIN_LOAD   256UL
 
-#if TICKS_PER_US == 0
-#error "BR_HAL_SYS_CLOCK_HZ must be >= 1MHz for microsecond timer resolution"
-#endif
+/* Time at the start of the current period */
+static volatile br_tick_t base_ticks;
 
-static volatile uint64_t timer_overflow_us;
-static volatile uint32_t systick_reload;
+static volatile uint32_t last_load;     /* Cycles in the current period */
+static volatile uint32_t overflow_cyc;  /* Wraps seen, not yet folded in */
 
-static volatile br_time_t alarm_target;
+static volatile br_tick_t alarm_target;
 static volatile bool      alarm_pending;
-static volatile br_time_t last_tick_time;
+static volatile bool      in_tick;      /* SysTick_Handler reprograms */
 
 extern void br_time_alarm_handler(void);
-extern void br_sched_tick(br_time_t elapsed_us);
+extern void br_sched_tick(br_tick_t now);
 
 void br_hal_timer_init(void)
 {
-    systick_reload = 0x00FFFFFF;
-    SYST_RVR = systick_reload;
-    SYST_CVR = 0;
-    SYST_CSR = 0x07;
+#if CONFIG_ARM_BASEPRI
+    /* SysTick calls the kernel, so kernel sections must mask it */
+    SCB_SHPR3 = (SCB_SHPR3 & 0x00FFFFFFUL) |
+                ((uint32_t)CONFIG_ARM_BASEPRI_THRESHOLD << 24);
+#endif
 
-    timer_overflow_us = 0;
+    base_ticks    = 0;
+    overflow_cyc  = 0;
     alarm_target  = 0;
     alarm_pending = false;
-    last_tick_time = 0;
+    in_tick       = false;
+
+#if !defined(__ARM_ARCH_6M__)
+    DEMCR     |= DEMCR_TRCENA;
+    DWT_CYCCNT = 0;
+    DWT_CTRL  |= DWT_CTRL_CYCCNTENA;
+#endif
+
+    last_load = MAX_LOAD;
+    SYST_RVR = MAX_LOAD - 1U;
+    SYST_CVR = 0;
+    SYST_CSR = 0x07;
+}
+
+/*
+ * Cycles since the start of the current period, counting wraps the ISR
+ * has not handled yet.  *cvr receives the counter value it is based on.
+ * Reading SYST_CSR clears COUNTFLAG, so a wrap is counted exactly once.
+ * IRQs disabled.
+ */
+static uint32_t elapsed(uint32_t *cvr)
+{
+    uint32_t val1 = SYST_CVR;
+    uint32_t ctrl = SYST_CSR;
+    uint32_t val2 = SYST_CVR;
+
+    if ((ctrl & SYST_CSR_COUNTFLAG) != 0 || val1 < val2) {
+        overflow_cyc += last_load;
+        (void)SYST_CSR;    /* Drop a COUNTFLAG set after ctrl was read */
+    }
+
+    *cvr = val2;
+    return (last_load - 1U - val2) + overflow_cyc;
+}
+
+/*
+ * Fold the elapsed cycles into the time base and restart SysTick for a
+ * period that ends at the pending alarm.  IRQs disabled.
+ */
+static void timer_program(void)
+{
+    uint32_t cvr;
+    base_ticks += elapsed(&cvr);
+    overflow_cyc = 0;
+
+    uint32_t load = MAX_LOAD;
+    if (alarm_pending) {
+        if (alarm_target <= base_ticks + MIN_LOAD) {
+            load = MIN_LOAD;
+        } else if (alarm_target - base_ticks < MAX_LOAD) {
+            load = (uint32_t)(alarm_target - base_ticks);
+        }
+    }
+
+    uint32_t old_load = last_load;
+    uint32_t val1 = SYST_CVR;
+    SYST_RVR  = load - 1U;
+    SYST_CVR  = 0;             /* Reloads from SYST_RVR on the next cycle */
+    uint32_t val2 = SYST_CVR;
+    last_load = load;
+
+    /*
+     * The new period starts at the reload.  Up to val1: the cycles since
+     * the fold, across a wrap if the old period ran out meanwhile.  From
+     * val1 to the reload: the reset itself cannot be seen, so it counts
+     * as long as the reload cycle and the new period up to val2, load -
+     * val2 -- one SysTick access on either side of the store.
+     */
+    base_ticks += (cvr >= val1 ? cvr - val1 : cvr + (old_load - val1)) +
+                  (load - val2);
 }
 
-br_time_t br_hal_timer_get_us(void)
+br_tick_t br_hal_timer_get_ticks(void)
 {
     uint32_t key = br_hal_irq_disable();
 
-    uint64_t base = timer_overflow_us;
-    uint32_t current = systick_reload - SYST_CVR;
-    uint32_t us_frac = current / TICKS_PER_US;
+    uint32_t cvr;
+    br_tick_t now = base_ticks + elapsed(&cvr);
 
     br_hal_irq_restore(key);
 
-    return base + us_frac;
+    return now;
+}
+
+br_cycles_t br_hal_cycles_now(void)
+{
+#if defined(__ARM_ARCH_6M__)
+    return (br_cycles_t)br_hal_timer_get_ticks();
+#else
+    return DWT_CYCCNT;
+#endif
 }
 
-void br_hal_timer_set_alarm(br_time_t abs_us)
+void br_hal_timer_set_alarm(br_tick_t abs_ticks)
 {
-    alarm_target  = abs_us;
-    alarm_pending = true;
+    uint32_t key = br_hal_irq_disable();
+
+    /* Reprogramming for the same target would only cost accuracy */
+    if (!alarm_pending || abs_ticks != alarm_target) {
+        alarm_target  = abs_ticks;
+        alarm_pending = true;
+        if (!in_tick) {
+            timer_program();
+        }
+    }
+
+    br_hal_irq_restore(key);
 }
 
 void br_hal_timer_cancel_alarm(void)
 {
+    /* The current period just runs out; SysTick_Handler then programs a
+     * full-range one */
     alarm_pending = false;
 }
 
 void SysTick_Handler(void)
 {
-    br_time_t tick_period_us = (uint64_t)(systick_reload + 1) / TICKS_PER_US;
-    timer_overflow_us += tick_period_us;
+    in_tick = true;
 
-    /* Handle round-robin time slicing */
-    br_time_t now = timer_overflow_us;
-    br_time_t elapsed = now - last_tick_time;
-    last_tick_time = now;
-    br_sched_tick(elapsed);
+    /* Round-robin slices and budgets end through the alarm as well; the
+     * scheduler checks them at every SysTick interrupt */
+    br_tick_t now = br_hal_timer_get_ticks();
+    br_sched_tick(now);
 
-    /* Handle alarm for tickless sleep */
-    if (alarm_pending) {
-        if (now >= alarm_target) {
-            alarm_pending = false;
-            br_time_alarm_handler();
-        }
+    if (alarm_pending && now >= alarm_target) {
+        alarm_pending = false;
+        br_time_alarm_handler();
     }
+
+    /* One restart for whatever the kernel asked for meanwhile */
+    uint32_t key = br_hal_irq_disable();
+    in_tick = false;
+    timer_program();
+    br_hal_irq_restore(key);
+}
+
+/*
+ * Interrupt control
+ *
+ * Kernel sections set PRIMASK, or with CONFIG_ARM_BASEPRI raise BASEPRI
+ * to CONFIG_ARM_BASEPRI_THRESHOLD.  BASEPRI_MAX only ever raises the
+ * mask, so nested sections work; interrupts above the threshold stay
+ * live throughout.
+ */
+
+#if CONFIG_ARM_BASEPRI
+
+uint32_t br_hal_irq_disable(void)
+{
+    uint32_t basepri;
+    __asm volatile ("mrs %0, basepri" : "=r" (basepri));
+    __asm volatile ("msr basepri_max, %0"
+                    :: "r" ((uint32_t)CONFIG_ARM_BASEPRI_THRESHOLD)
+                    : "memory");
+    return basepri;
+}
+
+void br_hal_irq_restore(uint32_t state)
+{
+    __asm volatile ("msr basepri, %0" :: "r" (state) : "memory");
 }
 
-/* Interrupt control */
+#else
 
 uint32_t br_hal_irq_disable(void)
 {
@@ -122,8 +265,58 @@ void br_hal_irq_restore(uint32_t state)
     __asm volatile ("msr primask, %0" :: "r" (state) : "memory");
 }
 
+#endif /* CONFIG_ARM_BASEPRI */
+
 bool br_hal_in_isr(void)
 {
     uint32_t icsr = SCB_ICSR;
     return (icsr & 0x1FF) != 0;
 }
+
+/* WFI also wakes for SysTick, so sleeps never outlast the next alarm */
+void br_hal_cpu_idle(void)
+{
+    __asm volatile ("dsb\n\twfi" ::: "memory");
+}
+
+#if CONFIG_PM
+
+/*
+ * Only plain WFI: deeper states (SCR.SLEEPDEEP) stop SysTick on most
+ * parts, and carrying the time base across them needs a low-power timer
+ * that is board-specific.  A board port extends this table with them.
+ */
+static const br_power_state_t power_states[] = {
+    { "wfi", 0, 0 },
+};
+
+const br_power_state_t *br_hal_power_states(uint32_t *count)
+{
+    *count = sizeof(power_states) / sizeof(power_states[0]);
+    return power_states;
+}
+
+/*
+ * WFI wakes for a pending interrupt even with PRIMASK set.  BASEPRI
+ * masking would keep SysTick from waking it, so with CONFIG_ARM_BASEPRI
+ * the mask moves to PRIMASK for the sleep.
+ */
+void br_hal_power_enter(uint32_t state)
+{
+    (void)state;
+#if CONFIG_ARM_BASEPRI
+    uint32_t basepri;
+    __asm volatile ("mrs %0, basepri" : "=r" (basepri));
+    __asm volatile ("cpsid i\n\t"
+                    "msr basepri, %0\n\t"
+                    "dsb\n\t"
+                    "wfi\n\t"
+                    "msr basepri, %1\n\t"
+                    "cpsie i"
+                    :: "r" (0U), "r" (basepri) : "memory");
+#else
+    __asm volatile ("dsb\n\twfi" ::: "memory");
+#endif
+}
+
+#endif /* CONFIG_PM */
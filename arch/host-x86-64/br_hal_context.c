@@ -12,9 +12,10 @@
  * execution stack in a statically allocated host_slot_t; the stack buffer
  * passed by the caller is only used for the stack-canary check.
  *
- * Slot association is keyed on stack_top so that deleted-and-recreated
- * tasks that reuse the same stack buffer reuse the same slot (necessary
- * for br_task_delete + recreate semantics in tests).
+ * The TCB's sp holds the task's slot.  br_hal_stack_release() puts the
+ * slot of a deleted task on a free list, so there are never more slots
+ * in use than live tasks and creating and deleting tasks can go on
+ * forever; the caller's stack buffer is never written to.
  */
 
 #include "bedrock/br_hal.h"
@@ -26,39 +27,52 @@
 #include <string.h>
 #include <stdint.h>
 
+#if CONFIG_SMP
+extern void br_sched_finish_switch(void);
+#endif
+
 #define HOST_EXEC_STACK_SIZE (128u * 1024u)
 
-typedef struct {
-    ucontext_t      uc;
-    br_task_entry_t entry;
-    void           *arg;
-    void           *stack_top_key;
-    bool            in_use;
-    char            exec_stack[HOST_EXEC_STACK_SIZE];
+typedef struct host_slot {
+    ucontext_t         uc;
+    br_task_entry_t    entry;
+    void              *arg;
+    struct host_slot  *next_free;
+    char              *exec_stack;      /* HOST_EXEC_STACK_SIZE, kept on reuse */
 } host_slot_t;
 
-static host_slot_t g_slots[CONFIG_MAX_TASKS];
+static host_slot_t  g_slots[CONFIG_MAX_TASKS];
+static uint32_t     g_slots_used;
+static host_slot_t *g_slots_free;    /* Released by deleted tasks */
 
-static host_slot_t *alloc_slot(void *stack_top)
+static host_slot_t *alloc_slot(void)
 {
-    for (int i = 0; i < CONFIG_MAX_TASKS; i++) {
-        if (g_slots[i].in_use && g_slots[i].stack_top_key == stack_top) {
-            return &g_slots[i];
-        }
+    host_slot_t *slot = g_slots_free;
+    if (slot != NULL) {
+        g_slots_free = slot->next_free;
+        return slot;
+    }
+
+    if (g_slots_used == CONFIG_MAX_TASKS) {
+        return NULL;
     }
-    for (int i = 0; i < CONFIG_MAX_TASKS; i++) {
-        if (!g_slots[i].in_use) {
-            g_slots[i].in_use        = true;
-            g_slots[i].stack_top_key = stack_top;
-            return &g_slots[i];
-        }
+
+    /* Allocated on first use, so unused slots cost no stack */
+    slot = &g_slots[g_slots_used];
+    slot->exec_stack = malloc(HOST_EXEC_STACK_SIZE);
+    if (slot->exec_stack == NULL) {
+        return NULL;
     }
-    return NULL;
+    g_slots_used++;
+    return slot;
 }
 
 static void task_trampoline(uint32_t ptr_hi, uint32_t ptr_lo)
 {
     host_slot_t *slot = (host_slot_t *)((uint64_t)ptr_hi << 32 | (uint64_t)ptr_lo);
+#if CONFIG_SMP
+    br_sched_finish_switch();
+#endif
     slot->entry(slot->arg);
     while (1) { }
 }
@@ -70,9 +84,14 @@ static void setup_context(host_slot_t *slot)
 {
     getcontext(&slot->uc);
     sigemptyset(&slot->uc.uc_sigmask);
+#if CONFIG_SMP
+    /* First switched to with a run queue locked; see task_trampoline() */
+    sigaddset(&slot->uc.uc_sigmask, SIGALRM);
+    sigaddset(&slot->uc.uc_sigmask, SIGUSR1);
+#endif
     slot->uc.uc_link          = NULL;
     slot->uc.uc_stack.ss_sp   = slot->exec_stack;
-    slot->uc.uc_stack.ss_size = sizeof(slot->exec_stack);
+    slot->uc.uc_stack.ss_size = HOST_EXEC_STACK_SIZE;
 
     uint64_t ptr = (uint64_t)(uintptr_t)slot;
     makecontext(&slot->uc, (void (*)(void))task_trampoline, 2,
@@ -82,7 +101,9 @@ static void setup_context(host_slot_t *slot)
 
 void *br_hal_stack_init(void *stack_top, br_task_entry_t entry, void *arg)
 {
-    host_slot_t *slot = alloc_slot(stack_top);
+    (void)stack_top;
+
+    host_slot_t *slot = alloc_slot();
     if (slot == NULL) {
         return NULL;
     }
@@ -94,6 +115,13 @@ void *br_hal_stack_init(void *stack_top, br_task_entry_t entry, void *arg)
     return slot;
 }
 
+void br_hal_stack_release(void *sp)
+{
+    host_slot_t *slot = (host_slot_t *)sp;
+    slot->next_free = g_slots_free;
+    g_slots_free    = slot;
+}
+
 void br_hal_context_switch(void **old_sp, void **new_sp)
 {
     host_slot_t *old_slot = *(host_slot_t **)old_sp;
@@ -0,0 +1,125 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * Host x86-64 SMP HAL (CONFIG_SMP builds only).
+ *
+ * Virtual CPUs : CPU 0 is the thread that calls br_kernel_start(); CPUs
+ *                1 .. CONFIG_NUM_CPUS - 1 are POSIX threads created by
+ *                br_hal_smp_start().  Task contexts (ucontext_t) are not
+ *                tied to a thread: a task switched out on one CPU may be
+ *                resumed by swapcontext(3) on another.  The CPU index is
+ *                kept in thread-local storage, which swapcontext does not
+ *                touch, so br_hal_cpu_id() always names the thread the
+ *                code is executing on.
+ *
+ * IPIs         : SIGUSR1 sent to the target thread with pthread_kill(3).
+ *                Handled in br_hal_timer.c together with SIGALRM.
+ *
+ * Spinlocks    : test-and-test-and-set on a 32-bit word.  Waiters call
+ *                sched_yield(2) so that a lock holder descheduled by the
+ *                host still makes progress when there are fewer host
+ *                cores than virtual CPUs.
+ *
+ * Kernel lock  : br_hal_irq_disable() masks the IRQ signals on the calling
+ *                thread and takes a recursive kernel-wide spinlock.  The
+ *                returned state encodes both: bit 0 = signals were already
+ *                masked, bit 1 = this CPU already held the kernel lock.
+ */
+
+#include "bedrock/br_hal.h"
+
+#if !CONFIG_SMP
+#error "br_hal_smp.c is only part of CONFIG_SMP builds"
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+
+#define KLOCK_NONE  UINT32_MAX
+
+static _Thread_local uint32_t g_cpu_id;
+
+static pthread_t              g_cpu_thread[CONFIG_NUM_CPUS];
+static void                 (*g_secondary_entry)(void);
+
+static br_spinlock_t          g_kernel_lock;
+static volatile uint32_t      g_kernel_lock_owner = KLOCK_NONE;
+
+uint32_t br_hal_cpu_id(void)
+{
+    return g_cpu_id;
+}
+
+static void *secondary_thread(void *arg)
+{
+    g_cpu_id = (uint32_t)(uintptr_t)arg;
+    g_secondary_entry();
+    return NULL;
+}
+
+void br_hal_smp_start(void (*entry)(void))
+{
+    g_cpu_thread[0]   = pthread_self();
+    g_secondary_entry = entry;
+
+    /* The caller has its IRQ signals masked; new threads inherit that */
+    for (uint32_t cpu = 1; cpu < CONFIG_NUM_CPUS; cpu++) {
+        if (pthread_create(&g_cpu_thread[cpu], NULL, secondary_thread,
+                           (void *)(uintptr_t)cpu) != 0) {
+            br_hal_panic("Cannot start secondary CPU", __FILE__, __LINE__);
+        }
+    }
+}
+
+void br_hal_ipi_send(uint32_t cpu)
+{
+    pthread_kill(g_cpu_thread[cpu], SIGUSR1);
+}
+
+void br_hal_spin_lock(br_spinlock_t *lock)
+{
+    while (__atomic_exchange_n(&lock->locked, 1U, __ATOMIC_ACQUIRE) != 0U) {
+        while (__atomic_load_n(&lock->locked, __ATOMIC_RELAXED) != 0U) {
+            sched_yield();
+        }
+    }
+}
+
+bool br_hal_spin_trylock(br_spinlock_t *lock)
+{
+    return __atomic_load_n(&lock->locked, __ATOMIC_RELAXED) == 0U &&
+           __atomic_exchange_n(&lock->locked, 1U, __ATOMIC_ACQUIRE) == 0U;
+}
+
+void br_hal_spin_unlock(br_spinlock_t *lock)
+{
+    __atomic_store_n(&lock->locked, 0U, __ATOMIC_RELEASE);
+}
+
+uint32_t br_hal_irq_disable(void)
+{
+    uint32_t state = br_hal_irq_local_disable();
+
+    if (g_kernel_lock_owner == g_cpu_id) {
+        return state | 2U;
+    }
+
+    br_hal_spin_lock(&g_kernel_lock);
+    g_kernel_lock_owner = g_cpu_id;
+    return state;
+}
+
+void br_hal_irq_restore(uint32_t state)
+{
+    if ((state & 2U) == 0U) {
+        g_kernel_lock_owner = KLOCK_NONE;
+        br_hal_spin_unlock(&g_kernel_lock);
+    }
+    br_hal_irq_local_restore(state & 1U);
+}
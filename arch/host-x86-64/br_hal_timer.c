@@ -9,10 +9,20 @@
  * Host x86-64 timer and interrupt-control HAL.
  *
  * Time source  : CLOCK_MONOTONIC via clock_gettime(3).
- * Tick / alarm : SIGALRM delivered by setitimer(ITIMER_REAL) at the
- *                round-robin quantum rate.  The signal handler checks
- *                whether a sleep alarm is due and calls the appropriate
- *                kernel handlers.
+ * Alarm        : a POSIX timer (timer_create(2)) on CLOCK_MONOTONIC that
+ *                raises SIGALRM, armed by br_hal_timer_set_alarm() with
+ *                an absolute one-shot deadline.  Slice ends and budget
+ *                limits come through the same alarm, so an idle process
+ *                takes no signals at all.  The signal handler checks
+ *                whether the alarm is due and calls the appropriate
+ *                kernel handlers.  Reschedules requested while the handler
+ *                runs are deferred and performed once, by
+ *                br_sched_isr_exit(), as the last step of the handler.
+ * Idle         : the idle task blocks in sigsuspend(2) until a signal
+ *                arrives, so an idle process uses no host CPU either.
+ * Tick (SMP)   : CONFIG_SMP has no scheduler events on the alarm, so a
+ *                second POSIX timer raises SIGALRM periodically at the
+ *                round-robin quantum rate for br_sched_tick().
  *
  * IRQ disable/restore maps to sigprocmask(2) on SIGALRM so that the
  *   kernel's critical-section protocol (irq_disable / irq_restore) works
@@ -20,10 +30,18 @@
  *     irq_disable() returns 0 if SIGALRM was unblocked, 1 if already blocked.
  *     irq_restore(0) unblocks; irq_restore(1) is a no-op.
  *
+ * With CONFIG_SMP the same functions become br_hal_irq_local_disable() /
+ *   br_hal_irq_local_restore() and also mask SIGUSR1, the emulated IPI
+ *   (see br_hal_smp.c, which layers the kernel lock on top).  SIGALRM is
+ *   process-directed, so the tick is taken by whichever virtual CPU has it
+ *   unmasked; its handler holds the kernel lock while it runs the kernel
+ *   handlers.  Every virtual CPU has its own in-ISR flag.
+ *
  * Signal-mask invariant after context switches
  * --------------------------------------------
  * swapcontext(3) saves and restores uc_sigmask.  Every new task context
- * is created with an empty mask (SIGALRM unblocked).  After resuming from
+ * is created with an empty mask (SIGALRM unblocked); under CONFIG_SMP it
+ * starts masked instead and br_sched_finish_switch() unmasks it.  After resuming from
  * a voluntary switch, the caller always follows with irq_restore(key) which
  * explicitly sets the mask to the correct state, overriding whatever
  * swapcontext restored.  After resuming from an involuntary (signal)
@@ -34,96 +52,185 @@
 #include "bedrock/br_hal.h"
 
 #include <signal.h>
-#include <sys/time.h>
 #include <time.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 
 extern void br_time_alarm_handler(void);
-extern void br_sched_tick(br_time_t elapsed_us);
+extern void br_sched_tick(br_tick_t now);
+extern void br_sched_isr_exit(void);
 
+#if CONFIG_SMP
+static _Thread_local volatile bool g_in_isr;
+#else
 static volatile bool      g_in_isr;
-static volatile br_time_t g_alarm_target;
+#endif
+static volatile br_tick_t g_alarm_target;
 static volatile bool      g_alarm_pending;
-static volatile br_time_t g_last_tick_us;
 static struct timespec    g_start_time;
 static sigset_t           g_alarm_sigset;
+static timer_t            g_alarm_timer;
+#if CONFIG_SMP
+static timer_t            g_tick_timer;
+#endif
 
 static void sigalrm_handler(int sig)
 {
     (void)sig;
     g_in_isr = true;
 
-    br_time_t now = br_hal_timer_get_us();
+#if CONFIG_SMP
+    uint32_t key = br_hal_irq_disable();
+#endif
+
+    br_tick_t now = br_hal_timer_get_ticks();
 
     if (g_alarm_pending && now >= g_alarm_target) {
         g_alarm_pending = false;
         br_time_alarm_handler();
-        now = br_hal_timer_get_us();
+        now = br_hal_timer_get_ticks();
     }
 
-    br_time_t elapsed = now - g_last_tick_us;
-    g_last_tick_us = now;
-    br_sched_tick(elapsed);
+    br_sched_tick(now);
+
+#if CONFIG_SMP
+    br_hal_irq_restore(key);
+#endif
 
     g_in_isr = false;
+    br_sched_isr_exit();
 }
 
+#if CONFIG_SMP
+/* Emulated IPI: another CPU asked this one to reschedule */
+static void sigusr1_handler(int sig)
+{
+    (void)sig;
+    br_sched_isr_exit();
+}
+#endif
+
 void br_hal_timer_init(void)
 {
     clock_gettime(CLOCK_MONOTONIC, &g_start_time);
     g_alarm_pending = false;
     g_alarm_target  = 0;
-    g_last_tick_us  = 0;
     g_in_isr        = false;
 
     sigemptyset(&g_alarm_sigset);
     sigaddset(&g_alarm_sigset, SIGALRM);
+#if CONFIG_SMP
+    sigaddset(&g_alarm_sigset, SIGUSR1);
+#endif
 
     struct sigaction sa;
     memset(&sa, 0, sizeof(sa));
     sa.sa_handler = sigalrm_handler;
     sa.sa_flags   = SA_RESTART;
-    sigemptyset(&sa.sa_mask);
+    sa.sa_mask    = g_alarm_sigset;
     sigaction(SIGALRM, &sa, NULL);
 
-    struct itimerval itv;
-    itv.it_interval.tv_sec  = 0;
-    itv.it_interval.tv_usec = CONFIG_RR_TIME_SLICE_US;
-    itv.it_value.tv_sec     = 0;
-    itv.it_value.tv_usec    = CONFIG_RR_TIME_SLICE_US;
-    setitimer(ITIMER_REAL, &itv, NULL);
+#if CONFIG_SMP
+    sa.sa_handler = sigusr1_handler;
+    sigaction(SIGUSR1, &sa, NULL);
+#endif
+
+    struct sigevent sev;
+    memset(&sev, 0, sizeof(sev));
+    sev.sigev_notify = SIGEV_SIGNAL;
+    sev.sigev_signo  = SIGALRM;
+    if (timer_create(CLOCK_MONOTONIC, &sev, &g_alarm_timer) != 0) {
+        br_hal_panic("Cannot create alarm timer", __FILE__, __LINE__);
+    }
+
+#if CONFIG_SMP
+    if (timer_create(CLOCK_MONOTONIC, &sev, &g_tick_timer) != 0) {
+        br_hal_panic("Cannot create tick timer", __FILE__, __LINE__);
+    }
+
+    struct itimerspec its;
+    its.it_interval.tv_sec  = 0;
+    its.it_interval.tv_nsec = CONFIG_RR_TIME_SLICE_US * 1000L;
+    its.it_value            = its.it_interval;
+    timer_settime(g_tick_timer, 0, &its, NULL);
+#endif
 }
 
-br_time_t br_hal_timer_get_us(void)
+/* Ticks count at BR_HAL_SYS_CLOCK_HZ, like the cycle counter of the
+ * target, so the kernel's tick conversions are exercised on the host */
+br_tick_t br_hal_timer_get_ticks(void)
 {
     struct timespec now;
     clock_gettime(CLOCK_MONOTONIC, &now);
     int64_t sec_diff  = (int64_t)now.tv_sec  - (int64_t)g_start_time.tv_sec;
     int64_t nsec_diff = (int64_t)now.tv_nsec - (int64_t)g_start_time.tv_nsec;
-    return (br_time_t)((sec_diff * 1000000000LL + nsec_diff) / 1000LL);
+    if (nsec_diff < 0) {
+        sec_diff  -= 1;
+        nsec_diff += 1000000000LL;
+    }
+    return (br_tick_t)sec_diff * BR_HAL_SYS_CLOCK_HZ +
+           (br_tick_t)nsec_diff * BR_HAL_SYS_CLOCK_HZ / 1000000000U;
+}
+
+/* The tick clock itself: the TSC rate is not known up front, and cycles
+ * must count at BR_HAL_SYS_CLOCK_HZ to convert like the target's */
+br_cycles_t br_hal_cycles_now(void)
+{
+    return (br_cycles_t)br_hal_timer_get_ticks();
 }
 
-void br_hal_timer_set_alarm(br_time_t abs_us)
+void br_hal_timer_set_alarm(br_tick_t abs_ticks)
 {
-    g_alarm_target  = abs_us;
+    g_alarm_target  = abs_ticks;
     g_alarm_pending = true;
+
+    /* Round up, so the handler never finds the alarm not yet due; a
+     * deadline already past fires at once */
+    br_tick_t rem  = abs_ticks % BR_HAL_SYS_CLOCK_HZ;
+    uint64_t  nsec = (uint64_t)g_start_time.tv_nsec +
+                     (rem * 1000000000U + BR_HAL_SYS_CLOCK_HZ - 1U) /
+                     BR_HAL_SYS_CLOCK_HZ;
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec  = g_start_time.tv_sec +
+                           (time_t)(abs_ticks / BR_HAL_SYS_CLOCK_HZ) +
+                           (time_t)(nsec / 1000000000U);
+    its.it_value.tv_nsec = (long)(nsec % 1000000000U);
+    timer_settime(g_alarm_timer, TIMER_ABSTIME, &its, NULL);
 }
 
 void br_hal_timer_cancel_alarm(void)
 {
     g_alarm_pending = false;
+
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    timer_settime(g_alarm_timer, 0, &its, NULL);
+}
+
+void br_hal_pend_reschedule(void)
+{
+    /* SIGALRM is the only interrupt source and sigalrm_handler() always
+     * drains the deferred reschedule on exit. */
 }
 
+#if CONFIG_SMP
+uint32_t br_hal_irq_local_disable(void)
+#else
 uint32_t br_hal_irq_disable(void)
+#endif
 {
     sigset_t old;
     sigprocmask(SIG_BLOCK, &g_alarm_sigset, &old);
     return sigismember(&old, SIGALRM) ? 1u : 0u;
 }
 
+#if CONFIG_SMP
+void br_hal_irq_local_restore(uint32_t state)
+#else
 void br_hal_irq_restore(uint32_t state)
+#endif
 {
     if (state == 0) {
         sigprocmask(SIG_UNBLOCK, &g_alarm_sigset, NULL);
@@ -134,3 +241,62 @@ bool br_hal_in_isr(void)
 {
     return g_in_isr;
 }
+
+/*
+ * Block until a signal handler has run, instead of spinning a host core:
+ * SIGALRM, and under CONFIG_SMP the SIGUSR1 IPI, stand in for the
+ * interrupts that wake a CPU from WFI.
+ */
+void br_hal_cpu_idle(void)
+{
+    sigset_t mask;
+    sigprocmask(SIG_SETMASK, NULL, &mask);
+    sigdelset(&mask, SIGALRM);
+#if CONFIG_SMP
+    sigdelset(&mask, SIGUSR1);
+#endif
+    sigsuspend(&mask);
+}
+
+#if CONFIG_PM
+
+/*
+ * Mock power states.  The host cannot really sleep deeper, so the
+ * latencies are simulated by spinning: before waiting for the wakeup
+ * signal for the entry latency, and after it for the exit latency, before
+ * the signal is delivered.  That delays the kernel the way a real wakeup
+ * would, and the idle governor's choices and lateness can be tested.
+ */
+static const br_power_state_t power_states[] = {
+    { "wait",  0,   0    },
+    { "sleep", 100, 400  },
+    { "deep",  500, 2000 },
+};
+
+const br_power_state_t *br_hal_power_states(uint32_t *count)
+{
+    *count = sizeof(power_states) / sizeof(power_states[0]);
+    return power_states;
+}
+
+static void spin_ticks(br_tick_t ticks)
+{
+    br_tick_t end = br_hal_timer_get_ticks() + ticks;
+    while (br_hal_timer_get_ticks() < end) { }
+}
+
+/* SIGALRM is blocked here (interrupts disabled) */
+void br_hal_power_enter(uint32_t state)
+{
+    const br_power_state_t *s = &power_states[state];
+    int sig;
+
+    spin_ticks(br_us_to_ticks(s->entry_latency));
+    sigwait(&g_alarm_sigset, &sig);
+    spin_ticks(br_us_to_ticks(s->exit_latency));
+
+    /* sigwait() consumed the signal; leave it pending for the handler */
+    raise(SIGALRM);
+}
+
+#endif /* CONFIG_PM */
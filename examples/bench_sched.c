@@ -0,0 +1,122 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Scheduler micro-benchmark: cost of a reschedule.
+ *
+ * The bench task is the only task at its priority, so every
+ * br_task_yield() goes through br_sched_reschedule() and stays on the
+ * fast path.  The loop is timed first with an empty ready queue, then
+ * again with BENCH_FILLERS lower-priority tasks ready, to show that the
+ * cost does not depend on how many tasks are queued.
+ *
+ * Last, a peer joins the bench task's priority.  Each yield now requeues
+ * the caller at the tail of its level and switches to the peer, which
+ * yields straight back, so the loop times a same-level requeue and
+ * context switch; the figure is per switch.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#define BENCH_ITERATIONS  100000U
+#define BENCH_FILLERS     8
+
+static uint8_t stack_bench[1024];
+static uint8_t stack_filler[BENCH_FILLERS][512];
+static uint8_t stack_peer[512];
+
+static volatile bool bench_done;
+static br_sem_t park;                 /* Never given */
+
+static void filler_task(void *arg)
+{
+    (void)arg;
+    while (1) { }
+}
+
+static void peer_task(void *arg)
+{
+    (void)arg;
+    while (!bench_done) {
+        br_task_yield();
+    }
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+/* Average cost of one no-switch yield, in nanoseconds */
+static uint32_t measure_yield_ns(void)
+{
+    br_time_t start = br_uptime_us();
+    for (uint32_t i = 0; i < BENCH_ITERATIONS; i++) {
+        br_task_yield();
+    }
+    br_time_t elapsed = br_uptime_us() - start;
+
+    return (uint32_t)((elapsed * 1000U) / BENCH_ITERATIONS);
+}
+
+static void report(const char *label, uint32_t ns)
+{
+    br_uart_puts(label);
+    put_u32(ns);
+    br_uart_puts(" ns/call");
+#if !defined(__x86_64__)
+    br_uart_puts(" (~");
+    put_u32((uint32_t)(((uint64_t)ns * (BR_HAL_SYS_CLOCK_HZ / 1000000U)) / 1000U));
+    br_uart_puts(" cycles)");
+#endif
+    br_uart_puts("\n");
+}
+
+static void bench_task(void *arg)
+{
+    (void)arg;
+
+    br_uart_puts("\n=== Scheduler Benchmark ===\n\n");
+
+    report("no-op reschedule, idle only:       ", measure_yield_ns());
+
+    for (int i = 0; i < BENCH_FILLERS; i++) {
+        br_task_create(NULL, "filler", filler_task, NULL, 3,
+                       stack_filler[i], sizeof(stack_filler[i]));
+    }
+
+    report("no-op reschedule, 8 tasks queued:  ", measure_yield_ns());
+
+    br_task_create(NULL, "peer", peer_task, NULL, 1,
+                   stack_peer, sizeof(stack_peer));
+
+    /* Two switches per iteration: to the peer and back */
+    report("same-level yield, per switch:      ", measure_yield_ns() / 2U);
+    bench_done = true;
+    br_task_yield();
+
+    br_uart_puts("\n=== Benchmark Complete ===\n");
+
+    while (1) {
+        br_sleep_ms(1000);
+    }
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_sem_init(&park, 0, 1);
+
+    br_task_create(NULL, "bench", bench_task, NULL,
+                   1, stack_bench, sizeof(stack_bench));
+
+    br_kernel_start();
+}
@@ -0,0 +1,39 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Console output shared by the examples.
+ */
+
+#ifndef EXAMPLE_IO_H
+#define EXAMPLE_IO_H
+
+#include <stdint.h>
+
+/* UART output (defined in the HAL's br_hal_uart.c) */
+extern void br_uart_puts(const char *s);
+
+/* Print an unsigned decimal number */
+static inline void put_u32(uint32_t val)
+{
+    char buf[11];
+    int i = 10;
+    buf[i] = '\0';
+    do {
+        buf[--i] = (char)('0' + (val % 10));
+        val /= 10;
+    } while (val > 0 && i > 0);
+    br_uart_puts(&buf[i]);
+}
+
+#endif /* EXAMPLE_IO_H */
@@ -24,9 +24,13 @@ static uint8_t stack_task_b[1024];
 static void task_a(void *arg)
 {
     (void)arg;
+
+    /* Every 500 ms, however long the output takes */
+    br_periodic_t tick;
+    br_periodic_init(&tick, BR_MSEC(500));
     while (1) {
         br_uart_puts("[A] tick\n");
-        br_sleep_ms(500);
+        br_periodic_wait(&tick);
     }
 }
 
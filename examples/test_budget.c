@@ -0,0 +1,140 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * CPU budget test (requires CONFIG_SCHED_BUDGET).
+ *
+ * Two high-priority CPU hogs share one group budget of BUDGET_MS per
+ * PERIOD_MS.  Without enforcement they would starve the low-priority
+ * background task completely.
+ *
+ * Test 1: the hogs together get about BUDGET_MS / PERIOD_MS of the CPU.
+ * Test 2: the background task gets the rest.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#if !CONFIG_SCHED_BUDGET
+#error "test_budget requires CONFIG_SCHED_BUDGET"
+#endif
+
+#define BUDGET_MS     20U
+#define PERIOD_MS     100U
+#define TEST_TIME_MS  1000U
+
+static uint8_t stack_supervisor[1024];
+static uint8_t stack_hog[2][1024];
+static uint8_t stack_background[1024];
+
+static br_budget_t hog_budget;
+
+static volatile br_time_t hog_run_us;
+static volatile br_time_t background_run_us;
+
+/*
+ * Spin forever, adding up the time this task was on the CPU: gaps
+ * between two samples longer than a few hundred microseconds mean the
+ * task was switched out.
+ */
+static void spin_and_measure(volatile br_time_t *run_us)
+{
+    br_time_t last = br_uptime_us();
+    while (1) {
+        br_time_t now = br_uptime_us();
+        if (now - last < 500U) {
+            *run_us += now - last;
+        }
+        last = now;
+    }
+}
+
+static void hog_task(void *arg)
+{
+    (void)arg;
+    spin_and_measure(&hog_run_us);
+}
+
+static void background_task(void *arg)
+{
+    (void)arg;
+    spin_and_measure(&background_run_us);
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_sleep_ms(TEST_TIME_MS);
+
+    uint32_t hog_ms = (uint32_t)(hog_run_us / 1000U);
+    uint32_t bg_ms  = (uint32_t)(background_run_us / 1000U);
+
+    br_uart_puts("\n=== CPU Budget Test ===\n\n");
+
+    br_uart_puts("Test 1: hogs ran ");
+    put_u32(hog_ms);
+    br_uart_puts(" ms of ");
+    put_u32(TEST_TIME_MS);
+    br_uart_puts(" (budget ");
+    put_u32(BUDGET_MS);
+    br_uart_puts("/");
+    put_u32(PERIOD_MS);
+    br_uart_puts(")");
+    if (hog_ms >= TEST_TIME_MS * BUDGET_MS / PERIOD_MS / 2 &&
+        hog_ms <= TEST_TIME_MS * (BUDGET_MS + 15U) / PERIOD_MS) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    br_uart_puts("Test 2: background ran ");
+    put_u32(bg_ms);
+    br_uart_puts(" ms");
+    if (bg_ms >= TEST_TIME_MS / 2) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    br_uart_puts("\n=== CPU Budget Test Complete ===\n");
+
+    while (1) {
+        br_sleep_ms(1000);
+    }
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_budget_init(&hog_budget, BR_MSEC(BUDGET_MS), BR_MSEC(PERIOD_MS));
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+    br_task_create(NULL, "background", background_task, NULL,
+                   4, stack_background, sizeof(stack_background));
+
+    for (int i = 0; i < 2; i++) {
+        br_task_attr_t attr;
+        br_task_attr_init(&attr);
+        attr.name     = "hog";
+        attr.priority = 2;
+        attr.budget   = &hog_budget;
+
+        br_task_create_attr(NULL, &attr, hog_task, NULL,
+                            stack_hog[i], sizeof(stack_hog[i]));
+    }
+
+    br_kernel_start();
+}
@@ -0,0 +1,276 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * EDF scheduling test (requires CONFIG_SCHED_EDF, EDF band at level 0).
+ *
+ * Three periodic EDF tasks are created before the scheduler starts, in
+ * order of decreasing deadline, next to a fixed-priority CPU hog below
+ * the EDF band.
+ *
+ * Test 1: the first jobs run in deadline order, not creation order.
+ * Test 2: no job finishes after its deadline while the hog is busy.
+ * Test 3: the hog still gets the CPU time the EDF tasks leave over.
+ * Test 4: an aperiodic EDF task woken long after its first job gets a
+ *         fresh deadline: the periodic tasks, with earlier deadlines,
+ *         still preempt its long second job and miss nothing.
+ * Test 5: an aperiodic EDF task that sleeps in the middle of a job keeps
+ *         the job's deadline: on waking it preempts a later-deadline
+ *         rival, which a deadline renewed at the wakeup would not.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#if !CONFIG_SCHED_EDF
+#error "test_edf requires CONFIG_SCHED_EDF"
+#endif
+
+#define EDF_TASKS     3
+#define TEST_TIME_MS  1000U
+#define APER_DEADLINE_MS  200U
+#define APER_WORK_MS      60U
+#define BLOCKER_DEADLINE_MS  100U
+#define BLOCKER_SLEEP_MS      90U   /* Renewed: 190 ms, after the rival */
+#define RIVAL_DEADLINE_MS    150U
+#define RIVAL_WORK_MS        150U
+
+typedef struct {
+    const char *name;
+    uint32_t    period_ms;     /* Deadline = period */
+    uint32_t    work_ms;
+    uint32_t    jobs;
+    uint32_t    misses;
+} edf_job_t;
+
+/* Created in this order: longest deadline first */
+static edf_job_t jobs[EDF_TASKS] = {
+    { "edf100", 100, 20, 0, 0 },
+    { "edf60",   60, 12, 0, 0 },
+    { "edf40",   40,  8, 0, 0 },
+};
+
+static uint8_t stack_supervisor[1024];
+static uint8_t stack_edf[EDF_TASKS][1024];
+static uint8_t stack_hog[1024];
+static uint8_t stack_aper[1024];
+static uint8_t stack_blocker[1024];
+static uint8_t stack_rival[1024];
+
+static int          first_run[EDF_TASKS];
+static int          first_run_count;
+static volatile uint32_t hog_loops;
+
+static br_sem_t          aper_go;
+static volatile uint32_t aper_jobs;
+static volatile uint32_t aper_preempted;   /* edf40 jobs during aper's */
+
+static br_sem_t          blocker_go;
+static br_sem_t          rival_go;
+static volatile uint32_t blocker_jobs;
+static volatile bool     rival_done;
+static volatile bool     rival_done_at_wake;
+
+static void edf_task(void *arg)
+{
+    int idx = (int)(uintptr_t)arg;
+    edf_job_t *job = &jobs[idx];
+    br_time_t release = br_uptime_us();
+
+    first_run[first_run_count++] = idx;
+
+    while (1) {
+        br_time_t end = br_uptime_us() + BR_MSEC(job->work_ms);
+        while (br_uptime_us() < end) { }
+
+        if (br_uptime_us() > release + BR_MSEC(job->period_ms)) {
+            job->misses++;
+        }
+        job->jobs++;
+
+        br_task_wait_next_period();
+        release += BR_MSEC(job->period_ms);
+    }
+}
+
+static void hog_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        hog_loops++;
+    }
+}
+
+/* Aperiodic: one job per give of aper_go */
+static void aper_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        br_sem_take(&aper_go, BR_TIME_INFINITE);
+        uint32_t before = jobs[2].jobs;
+        br_time_t end = br_uptime_us() + BR_MSEC(APER_WORK_MS);
+        while (br_uptime_us() < end) { }
+        aper_preempted = jobs[2].jobs - before;
+        aper_jobs++;
+    }
+}
+
+/* Starts the rival, then sleeps in the middle of its own job */
+static void blocker_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        br_sem_take(&blocker_go, BR_TIME_INFINITE);
+        br_sem_give(&rival_go);
+        br_sleep_ms(BLOCKER_SLEEP_MS);
+        rival_done_at_wake = rival_done;
+        blocker_jobs++;
+    }
+}
+
+static void rival_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        br_sem_take(&rival_go, BR_TIME_INFINITE);
+        br_time_t end = br_uptime_us() + BR_MSEC(RIVAL_WORK_MS);
+        while (br_uptime_us() < end) { }
+        rival_done = true;
+    }
+}
+
+static uint32_t total_misses(void)
+{
+    uint32_t misses = 0;
+    for (int i = 0; i < EDF_TASKS; i++) {
+        misses += jobs[i].misses;
+    }
+    return misses;
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_sleep_ms(TEST_TIME_MS);
+
+    br_uart_puts("\n=== EDF Test ===\n\n");
+
+    /* Test 1: deadline order of the first jobs */
+    br_uart_puts("Test 1: first jobs ran as");
+    for (int i = 0; i < first_run_count; i++) {
+        br_uart_puts(" ");
+        br_uart_puts(jobs[first_run[i]].name);
+    }
+    if (first_run_count == EDF_TASKS &&
+        first_run[0] == 2 && first_run[1] == 1 && first_run[2] == 0) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 2: deadline misses */
+    uint32_t misses = 0;
+    for (int i = 0; i < EDF_TASKS; i++) {
+        br_uart_puts("Test 2: ");
+        br_uart_puts(jobs[i].name);
+        br_uart_puts(" jobs = ");
+        put_u32(jobs[i].jobs);
+        br_uart_puts(", misses = ");
+        put_u32(jobs[i].misses);
+        br_uart_puts("\n");
+        misses += jobs[i].misses;
+    }
+    br_uart_puts(misses == 0 ? "Test 2: PASS\n" : "Test 2: FAIL\n");
+
+    /* Test 3: background progress */
+    br_uart_puts(hog_loops > 0 ? "Test 3: hog ran - PASS\n"
+                               : "Test 3: hog starved - FAIL\n");
+
+    /* Test 4: a stale deadline must not outrank the periodic tasks */
+    br_task_attr_t attr;
+    br_task_attr_init(&attr);
+    attr.name        = "aper";
+    attr.sched_class = BR_SCHED_EDF;
+    attr.deadline    = BR_MSEC(APER_DEADLINE_MS);
+    br_task_create_attr(NULL, &attr, aper_task, NULL,
+                        stack_aper, sizeof(stack_aper));
+    br_sleep_ms(2U * APER_DEADLINE_MS);      /* First deadline passes */
+
+    uint32_t misses_before = total_misses();
+    br_sem_give(&aper_go);
+    br_sleep_ms(2U * APER_WORK_MS);
+
+    br_uart_puts("Test 4: edf40 ran ");
+    put_u32(aper_preempted);
+    br_uart_puts(" jobs during the aperiodic job, new misses = ");
+    put_u32(total_misses() - misses_before);
+    if (aper_jobs == 1 && aper_preempted > 0 &&
+        total_misses() == misses_before) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 5: blocking inside a job keeps its deadline */
+    attr.name     = "blocker";
+    attr.deadline = BR_MSEC(BLOCKER_DEADLINE_MS);
+    br_task_create_attr(NULL, &attr, blocker_task, NULL,
+                        stack_blocker, sizeof(stack_blocker));
+    attr.name     = "rival";
+    attr.deadline = BR_MSEC(RIVAL_DEADLINE_MS);
+    br_task_create_attr(NULL, &attr, rival_task, NULL,
+                        stack_rival, sizeof(stack_rival));
+    br_sleep_ms(2U * RIVAL_DEADLINE_MS);     /* First deadlines pass */
+
+    br_sem_give(&blocker_go);
+    br_sleep_ms(2U * RIVAL_WORK_MS);
+
+    br_uart_puts(blocker_jobs == 1 && !rival_done_at_wake
+                 ? "Test 5: mid-job wakeup kept its deadline - PASS\n"
+                 : "Test 5: mid-job wakeup lost its deadline - FAIL\n");
+
+    br_uart_puts("\n=== EDF Test Complete ===\n");
+
+    while (1) {
+        br_sleep_ms(1000);
+    }
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_sem_init(&aper_go, 0, 1);
+    br_sem_init(&blocker_go, 0, 1);
+    br_sem_init(&rival_go, 0, 1);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+    br_task_create(NULL, "hog", hog_task, NULL,
+                   3, stack_hog, sizeof(stack_hog));
+
+    for (int i = 0; i < EDF_TASKS; i++) {
+        br_task_attr_t attr;
+        br_task_attr_init(&attr);
+        attr.name        = jobs[i].name;
+        attr.sched_class = BR_SCHED_EDF;
+        attr.deadline    = BR_MSEC(jobs[i].period_ms);
+        attr.period      = BR_MSEC(jobs[i].period_ms);
+
+        br_task_create_attr(NULL, &attr, edf_task, (void *)(uintptr_t)i,
+                            stack_edf[i], sizeof(stack_edf[i]));
+    }
+
+    br_kernel_start();
+}
@@ -0,0 +1,128 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Idle task test.
+ *
+ * Test 1: an idle hook with nothing left to do is called once per wakeup
+ *         while the only task sleeps, not continuously: the idle task
+ *         sleeps the CPU in between.
+ * Test 2: an idle hook with work pending is called back to back until it
+ *         reports it is done.
+ * Test 3: the idle task runs no hook once it is removed, and tasks still
+ *         wake on time from an idle CPU.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#define SLEEP_MS       100U
+#define MAX_WAKEUPS    10U      /* Hook calls allowed while asleep */
+#define WORK_ITEMS     5000U
+#define LATENESS_US    2000U
+
+static uint8_t stack_supervisor[1024];
+
+static volatile uint32_t hook_calls;
+static volatile uint32_t work_left;
+
+static bool count_hook(void)
+{
+    hook_calls++;
+    return false;
+}
+
+static bool work_hook(void)
+{
+    hook_calls++;
+    if (work_left > 0) {
+        work_left--;
+    }
+    return work_left > 0;
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_uart_puts("\n=== Idle Task Test ===\n\n");
+
+    /* Test 1: the idle task sleeps between wakeups */
+    hook_calls = 0;
+    br_set_idle_hook(count_hook);
+    br_sleep_ms(SLEEP_MS);
+    uint32_t calls = hook_calls;
+
+    br_uart_puts("Test 1: idle hook called ");
+    put_u32(calls);
+    br_uart_puts(" times in ");
+    put_u32(SLEEP_MS);
+    br_uart_puts(" ms");
+    if (calls >= 1 && calls <= MAX_WAKEUPS) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 2: background work runs to completion */
+    hook_calls = 0;
+    work_left  = WORK_ITEMS;
+    br_set_idle_hook(work_hook);
+    br_sleep_ms(SLEEP_MS);
+    calls = hook_calls;
+
+    br_uart_puts("Test 2: ");
+    put_u32(WORK_ITEMS - work_left);
+    br_uart_puts(" work items done in ");
+    put_u32(calls);
+    br_uart_puts(" hook calls");
+    if (work_left == 0 && calls >= WORK_ITEMS &&
+        calls <= WORK_ITEMS + MAX_WAKEUPS) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 3: no hook, on-time wakeup from an idle CPU */
+    br_set_idle_hook(NULL);
+    hook_calls = 0;
+    br_time_t start = br_uptime_us();
+    br_sleep_ms(SLEEP_MS);
+    br_time_t slept = br_uptime_us() - start;
+
+    br_uart_puts("Test 3: slept ");
+    put_u32((uint32_t)slept);
+    br_uart_puts(" us without a hook");
+    if (hook_calls == 0 && slept >= BR_MSEC(SLEEP_MS) &&
+        slept <= BR_MSEC(SLEEP_MS) + LATENESS_US) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    br_uart_puts("\n=== Idle Task Test Complete ===\n");
+
+    while (1) {
+        br_sleep_ms(1000);
+    }
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+
+    br_kernel_start();
+}
@@ -0,0 +1,143 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Large task count test (host, CONFIG_MAX_TASKS of 1024 or more).
+ *
+ * Test 1: tasks are created until the pool is full; every free slot
+ *         takes one, and each task runs.
+ * Test 2: all of them are deleted, and a second full set created; each
+ *         old ID is rejected, although its slot holds a new task.
+ * Test 3: the task IDs of one set are all distinct.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#if CONFIG_MAX_TASKS < 1024
+#error "test_many_tasks requires CONFIG_MAX_TASKS of 1024 or more"
+#endif
+
+/* Idle task, timer service and the supervisor hold the other slots */
+#define FLEET_SIZE    (CONFIG_MAX_TASKS - 2 - CONFIG_TIMERS)
+#define FLEET_STACK   64U
+
+static uint8_t stack_supervisor[1024];
+static uint8_t stack_fleet[FLEET_SIZE][FLEET_STACK];
+static uint8_t stack_spare[FLEET_STACK];
+
+static br_tid_t fleet[FLEET_SIZE];
+static br_tid_t old_fleet[FLEET_SIZE];
+static volatile uint32_t fleet_runs;
+static br_sem_t park;                 /* Never given */
+
+static void fleet_task(void *arg)
+{
+    (void)arg;
+    fleet_runs++;
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+/* Create tasks until the pool is full; the number created */
+static uint32_t create_fleet(void)
+{
+    uint32_t n = 0;
+    while (n < FLEET_SIZE &&
+           br_task_create(&fleet[n], "fleet", fleet_task, NULL, 2,
+                          stack_fleet[n], FLEET_STACK) == BR_OK) {
+        n++;
+    }
+    return n;
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_uart_puts("\n=== Many Tasks Test ===\n\n");
+
+    uint32_t created = create_fleet();
+    br_tid_t spare;
+    bool full = br_task_create(&spare, "spare", fleet_task, NULL, 2,
+                               stack_spare, FLEET_STACK) == BR_ERR_NOMEM;
+    br_sleep_ms(200);
+
+    br_uart_puts("Test 1: created ");
+    put_u32(created);
+    br_uart_puts(", ran ");
+    put_u32(fleet_runs);
+    if (created == FLEET_SIZE && full && fleet_runs == FLEET_SIZE) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    uint32_t deleted = 0;
+    for (uint32_t i = 0; i < created; i++) {
+        old_fleet[i] = fleet[i];
+        if (br_task_delete(fleet[i]) == BR_OK) {
+            deleted++;
+        }
+    }
+    uint32_t recreated = create_fleet();
+    br_sleep_ms(200);
+
+    uint32_t stale = 0;
+    for (uint32_t i = 0; i < created; i++) {
+        if (br_task_suspend(old_fleet[i]) == BR_ERR_INVALID) {
+            stale++;
+        }
+    }
+
+    br_uart_puts("Test 2: deleted ");
+    put_u32(deleted);
+    br_uart_puts(", recreated ");
+    put_u32(recreated);
+    br_uart_puts(", old IDs rejected ");
+    put_u32(stale);
+    if (deleted == FLEET_SIZE && recreated == FLEET_SIZE &&
+        stale == FLEET_SIZE && fleet_runs == 2U * FLEET_SIZE) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Each slot holds one task, so distinct IDs have distinct indices */
+    bool distinct = true;
+    for (uint32_t i = 0; i < recreated && distinct; i++) {
+        for (uint32_t j = i + 1; j < recreated; j++) {
+            if (fleet[i] == fleet[j]) {
+                distinct = false;
+                break;
+            }
+        }
+    }
+    br_uart_puts(distinct ? "Test 3: task IDs distinct - PASS\n"
+                          : "Test 3: duplicate task ID - FAIL\n");
+
+    br_uart_puts("\n=== Many Tasks Test Complete ===\n");
+
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_sem_init(&park, 0, 1);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+
+    br_kernel_start();
+}
@@ -0,0 +1,304 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Message queue handoff and zero-copy test.
+ *
+ * Test 1: a send to a blocked receiver goes straight into its buffer,
+ *         without passing through the queue.
+ * Test 2: blocked senders on a full queue have their messages queued
+ *         in order as receives free slots.
+ * Test 3: a woken sender's message cannot be overtaken: the slot freed
+ *         for it is not up for grabs before the sender runs again, so
+ *         every send that returned BR_OK is received.
+ * Test 4: a sender that times out leaves the queue untouched.
+ * Test 5: a reserved slot is filled and a peeked message read in place,
+ *         in the queue's own storage.
+ * Test 6: a peek blocked on an empty queue is granted the next message,
+ *         and other receivers wait until it is released.
+ * Test 7: a reservation blocked on a full queue is granted the slot a
+ *         receive frees, other senders wait until it is committed, and
+ *         commit / release without a reservation / peek are rejected.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#define CAPACITY       2U
+#define SENDERS        3
+#define HELPERS        (SENDERS + 6)
+
+static uint8_t stack_supervisor[1024];
+static uint8_t stack_helper[HELPERS][1024];
+static int     next_stack;
+
+static br_mqueue_t mq;
+static uint32_t    mq_storage[CAPACITY];
+
+static br_sem_t park;                  /* Never given */
+
+static uint32_t received;              /* Test 1 receiver's message */
+static br_err_t recv_result;
+static br_err_t send_result[SENDERS];
+
+static void    *held;                  /* Slot / message of Tests 6, 7 */
+static br_err_t held_result;
+
+static void receiver_task(void *arg)
+{
+    (void)arg;
+    recv_result = br_mqueue_recv(&mq, &received, BR_TIME_INFINITE);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+/* Sender i sends 100 + i, with a timeout of sender_timeout_ms[i]
+ * (0 = forever) */
+static uint32_t sender_timeout_ms[SENDERS];
+
+static void sender_task(void *arg)
+{
+    uint32_t idx = (uint32_t)(uintptr_t)arg;
+    uint32_t msg = 100U + idx;
+    br_time_t timeout = sender_timeout_ms[idx] != 0
+                        ? BR_MSEC(sender_timeout_ms[idx]) : BR_TIME_INFINITE;
+    send_result[idx] = br_mqueue_send(&mq, &msg, timeout);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void peeker_task(void *arg)
+{
+    (void)arg;
+    held_result = br_mqueue_peek(&mq, &held, BR_TIME_INFINITE);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void reserver_task(void *arg)
+{
+    (void)arg;
+    held_result = br_mqueue_reserve(&mq, &held, BR_TIME_INFINITE);
+    if (held_result == BR_OK) {
+        *(uint32_t *)held = 300;
+        br_sleep_ms(5);                      /* Hold the slot a while */
+        br_mqueue_commit(&mq);
+    }
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static bool in_storage(const void *p)
+{
+    return p == &mq_storage[0] || p == &mq_storage[1];
+}
+
+static void spawn(br_task_entry_t entry, uint32_t arg, uint8_t prio)
+{
+    br_task_create(NULL, "helper", entry, (void *)(uintptr_t)arg, prio,
+                   stack_helper[next_stack], sizeof(stack_helper[0]));
+    next_stack++;
+}
+
+static void send_now(uint32_t val)
+{
+    br_mqueue_send(&mq, &val, 0);
+}
+
+/* Receive everything queued; returns how many, values in out[] */
+static uint32_t drain(uint32_t *out, uint32_t max)
+{
+    uint32_t n = 0;
+    while (n < max && br_mqueue_recv(&mq, &out[n], 0) == BR_OK) {
+        n++;
+    }
+    return n;
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+    uint32_t got[8];
+    uint32_t n;
+
+    br_uart_puts("\n=== Message Queue Handoff and Zero-Copy Test ===\n\n");
+
+    /* Test 1: direct handoff to a blocked receiver */
+    spawn(receiver_task, 0, 2);
+    br_sleep_ms(5);                          /* Receiver blocks */
+    send_now(42);
+    size_t queued = mq.count;
+    br_sleep_ms(5);                          /* Receiver runs */
+
+    br_uart_puts("Test 1: receiver got ");
+    put_u32(received);
+    br_uart_puts(queued == 0 ? ", queue bypassed" : ", went through queue");
+    if (recv_result == BR_OK && received == 42 && queued == 0) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 2: senders blocked on a full queue, in order */
+    send_now(1);
+    send_now(2);
+    for (uint32_t i = 0; i < SENDERS; i++) {
+        send_result[i] = BR_ERR_INVALID;
+        spawn(sender_task, i, 3);
+        br_sleep_ms(2);                      /* Sender blocks */
+    }
+    n = drain(got, 8);
+
+    br_uart_puts("Test 2: received");
+    for (uint32_t i = 0; i < n; i++) {
+        br_uart_puts(" ");
+        put_u32(got[i]);
+    }
+    br_sleep_ms(5);                          /* Senders finish */
+    if (n == CAPACITY + SENDERS && got[0] == 1 && got[1] == 2 &&
+        got[2] == 100 && got[3] == 101 && got[4] == 102 &&
+        send_result[0] == BR_OK && send_result[1] == BR_OK &&
+        send_result[2] == BR_OK) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 3: a low-priority sender woken by a receive keeps its slot */
+    send_now(1);
+    send_now(2);
+    send_result[0] = BR_ERR_INVALID;
+    spawn(sender_task, 0, 4);
+    br_sleep_ms(2);                          /* Sender blocks */
+
+    br_mqueue_recv(&mq, &got[0], 0);         /* Frees a slot for it */
+    uint32_t late = 7;
+    br_err_t overtake = br_mqueue_send(&mq, &late, 0);
+    br_sleep_ms(5);                          /* Sender finishes */
+    n = drain(&got[1], 7) + 1;
+
+    bool kept = n == 3 && got[2] == 100;
+    br_uart_puts("Test 3: blocked sender's message ");
+    br_uart_puts(kept ? "kept" : "lost");
+    if (kept && send_result[0] == BR_OK && overtake == BR_ERR_TIMEOUT &&
+        got[0] == 1 && got[1] == 2) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 4: a timed-out sender */
+    send_now(1);
+    send_now(2);
+    send_result[1] = BR_ERR_INVALID;
+    sender_timeout_ms[1] = 10;
+    spawn(sender_task, 1, 3);
+    br_sleep_ms(20);                         /* Sender times out */
+    n = drain(got, 8);
+
+    br_uart_puts("Test 4: timed-out sender ");
+    br_uart_puts(send_result[1] == BR_ERR_TIMEOUT ? "returned BR_ERR_TIMEOUT"
+                                                  : "did not time out");
+    if (send_result[1] == BR_ERR_TIMEOUT && n == CAPACITY &&
+        got[0] == 1 && got[1] == 2) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 5: in-place produce and consume */
+    void *slot = NULL;
+    void *msg  = NULL;
+    br_err_t reserve = br_mqueue_reserve(&mq, &slot, 0);
+    if (reserve == BR_OK) {
+        *(uint32_t *)slot = 55;
+    }
+    size_t before_commit = mq.count;
+    br_mqueue_commit(&mq);
+    br_err_t peek = br_mqueue_peek(&mq, &msg, 0);
+    uint32_t value = peek == BR_OK ? *(const uint32_t *)msg : 0;
+    br_mqueue_release(&mq);
+
+    br_uart_puts("Test 5: read ");
+    put_u32(value);
+    br_uart_puts(" in place");
+    if (reserve == BR_OK && peek == BR_OK && slot == msg &&
+        in_storage(slot) && before_commit == 0 && value == 55 &&
+        mq.count == 0) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 6: blocked peek, receivers held off while it is held */
+    held_result = BR_ERR_INVALID;
+    spawn(peeker_task, 0, 2);
+    br_sleep_ms(2);                          /* Peeker blocks */
+    send_now(61);
+    send_now(62);
+    br_sleep_ms(2);                          /* Peeker runs */
+    uint32_t peeked = held_result == BR_OK ? *(const uint32_t *)held : 0;
+    br_err_t during = br_mqueue_recv(&mq, &got[0], 0);
+    br_mqueue_release(&mq);
+    n = drain(got, 8);
+
+    br_uart_puts("Test 6: peek granted ");
+    put_u32(peeked);
+    br_uart_puts(during == BR_ERR_TIMEOUT ? ", receive held off"
+                                          : ", receive not held off");
+    if (held_result == BR_OK && in_storage(held) && peeked == 61 &&
+        during == BR_ERR_TIMEOUT && n == 1 && got[0] == 62) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 7: blocked reservation, senders held off while it is held */
+    send_now(71);
+    send_now(72);
+    held_result = BR_ERR_INVALID;
+    spawn(reserver_task, 0, 2);
+    br_sleep_ms(2);                          /* Reserver blocks */
+    br_mqueue_recv(&mq, &got[0], 0);         /* Grants it the slot */
+    br_sleep_ms(1);                          /* Reserver fills it */
+    size_t pending = mq.count;
+    uint32_t late7 = 73;
+    br_err_t blocked = br_mqueue_send(&mq, &late7, 0);
+    br_sleep_ms(10);                         /* Reserver commits */
+    n = drain(&got[1], 7) + 1;
+    bool unheld = br_mqueue_commit(&mq) == BR_ERR_INVALID &&
+                  br_mqueue_release(&mq) == BR_ERR_INVALID;
+
+    br_uart_puts("Test 7: reservation granted");
+    br_uart_puts(blocked == BR_ERR_TIMEOUT ? ", send held off"
+                                           : ", send not held off");
+    if (held_result == BR_OK && pending == 1 && blocked == BR_ERR_TIMEOUT &&
+        n == 3 && got[0] == 71 && got[1] == 72 && got[2] == 300 && unheld) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    br_uart_puts("\n=== Message Queue Handoff and Zero-Copy Test Complete ===\n");
+
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_mqueue_init(&mq, mq_storage, sizeof(uint32_t), CAPACITY);
+    br_sem_init(&park, 0, 1);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+
+    br_kernel_start();
+}
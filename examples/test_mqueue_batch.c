@@ -0,0 +1,246 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Batched message queue test.
+ *
+ * Test 1: with min 0, batches move what fits (or what is queued) and
+ *         return at once, in order.
+ * Test 2: one batch send hands a message to each blocked receiver.
+ * Test 3: a batch receive waiting for at least MIN_WAIT messages returns
+ *         once that many have arrived one by one.
+ * Test 4: a batch send larger than the queue blocks until receives make
+ *         room, and every message arrives in order.
+ * Test 5: a batch receive that times out short of min reports what it
+ *         got; bad arguments are rejected.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#define CAPACITY       8U
+#define RECEIVERS      3
+#define MIN_WAIT       4U
+#define BIG_BATCH      20U
+#define HELPERS        (RECEIVERS + 2)
+
+static uint8_t stack_supervisor[2048];
+static uint8_t stack_helper[HELPERS][1024];
+static int     next_stack;
+
+static br_mqueue_t mq;
+static uint32_t    mq_storage[CAPACITY];
+
+static br_sem_t park;                  /* Never given */
+
+static uint32_t received[RECEIVERS];   /* Test 2 */
+
+static uint32_t          batch[BIG_BATCH];
+static volatile size_t   batch_count;
+static volatile br_err_t batch_result;
+static volatile bool     batch_done;
+
+static void spawn(br_task_entry_t entry, uint32_t arg, uint8_t prio)
+{
+    br_task_create(NULL, "helper", entry, (void *)(uintptr_t)arg, prio,
+                   stack_helper[next_stack], sizeof(stack_helper[0]));
+    next_stack++;
+}
+
+static void receiver_task(void *arg)
+{
+    uint32_t idx = (uint32_t)(uintptr_t)arg;
+    br_mqueue_recv(&mq, &received[idx], BR_TIME_INFINITE);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void batch_receiver_task(void *arg)
+{
+    (void)arg;
+    size_t got = 0;
+    batch_result = br_mqueue_recv_n(&mq, batch, BIG_BATCH, MIN_WAIT, &got,
+                                    BR_TIME_INFINITE);
+    batch_count = got;
+    batch_done  = true;
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void batch_sender_task(void *arg)
+{
+    (void)arg;
+    size_t sent = 0;
+    for (uint32_t i = 0; i < BIG_BATCH; i++) {
+        batch[i] = 1000U + i;
+    }
+    batch_result = br_mqueue_send_n(&mq, batch, BIG_BATCH, BIG_BATCH, &sent,
+                                    BR_TIME_INFINITE);
+    batch_count = sent;
+    batch_done  = true;
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static bool in_sequence(const uint32_t *v, size_t n, uint32_t first)
+{
+    for (size_t i = 0; i < n; i++) {
+        if (v[i] != first + i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void send_now(uint32_t val)
+{
+    br_mqueue_send(&mq, &val, 0);
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+    uint32_t out[BIG_BATCH];
+    uint32_t in[2 * CAPACITY];
+    size_t a = 0, b = 0, c = 0, d = 0;
+    br_err_t err;
+
+    br_uart_puts("\n=== Batched Message Queue Test ===\n\n");
+
+    /* Test 1: min 0 moves what is possible */
+    for (uint32_t i = 0; i < 10; i++) {
+        out[i] = i;
+    }
+    br_err_t e1 = br_mqueue_send_n(&mq, out, 5, 0, &a, 0);
+    br_err_t e2 = br_mqueue_send_n(&mq, &out[5], 5, 0, &b, 0);
+    br_err_t e3 = br_mqueue_recv_n(&mq, in, 2 * CAPACITY, 0, &c, 0);
+    br_err_t e4 = br_mqueue_recv_n(&mq, in, 2 * CAPACITY, 0, &d, 0);
+
+    br_uart_puts("Test 1: sent ");
+    put_u32((uint32_t)a);
+    br_uart_puts(" + ");
+    put_u32((uint32_t)b);
+    br_uart_puts(", received ");
+    put_u32((uint32_t)c);
+    br_uart_puts(" + ");
+    put_u32((uint32_t)d);
+    if (e1 == BR_OK && e2 == BR_OK && e3 == BR_OK && e4 == BR_OK &&
+        a == 5 && b == CAPACITY - 5 && c == CAPACITY && d == 0 &&
+        in_sequence(in, CAPACITY, 0)) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 2: one batch for several blocked receivers */
+    for (uint32_t i = 0; i < RECEIVERS; i++) {
+        spawn(receiver_task, i, 2);
+    }
+    br_sleep_ms(5);                          /* Receivers block */
+    for (uint32_t i = 0; i < RECEIVERS; i++) {
+        out[i] = 200U + i;
+    }
+    err = br_mqueue_send_n(&mq, out, RECEIVERS, RECEIVERS, &a, 0);
+    size_t queued = mq.count;
+    br_sleep_ms(5);                          /* Receivers run */
+
+    br_uart_puts("Test 2: ");
+    put_u32((uint32_t)a);
+    br_uart_puts(" messages handed to blocked receivers");
+    if (err == BR_OK && a == RECEIVERS && queued == 0 &&
+        in_sequence(received, RECEIVERS, 200)) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 3: wait for at least MIN_WAIT */
+    batch_done = false;
+    spawn(batch_receiver_task, 0, 2);
+    br_sleep_ms(2);                          /* Receiver blocks */
+    bool early = false;
+    for (uint32_t i = 0; i < MIN_WAIT; i++) {
+        if (batch_done) {
+            early = true;
+        }
+        send_now(300U + i);
+        br_sleep_ms(2);
+    }
+
+    br_uart_puts("Test 3: woke with ");
+    put_u32((uint32_t)batch_count);
+    br_uart_puts(" of at least ");
+    put_u32(MIN_WAIT);
+    if (!early && batch_done && batch_result == BR_OK &&
+        batch_count == MIN_WAIT && in_sequence(batch, MIN_WAIT, 300)) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 4: a batch larger than the queue */
+    batch_done = false;
+    spawn(batch_sender_task, 0, 2);
+    br_sleep_ms(2);                          /* Sender fills, blocks */
+    size_t full = mq.count;
+    size_t total = 0;
+    for (int round = 0; round < 10 && total < BIG_BATCH; round++) {
+        br_mqueue_recv_n(&mq, &out[total], BIG_BATCH - total, 0, &a, 0);
+        total += a;
+        br_sleep_ms(2);                      /* Sender refills */
+    }
+
+    br_uart_puts("Test 4: ");
+    put_u32((uint32_t)total);
+    br_uart_puts(" of ");
+    put_u32(BIG_BATCH);
+    br_uart_puts(" received through a queue of ");
+    put_u32(CAPACITY);
+    if (full == CAPACITY && batch_done && batch_result == BR_OK &&
+        batch_count == BIG_BATCH && total == BIG_BATCH &&
+        in_sequence(out, BIG_BATCH, 1000)) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 5: timeout short of min, bad arguments */
+    send_now(500);
+    send_now(501);
+    err = br_mqueue_recv_n(&mq, in, 4, 3, &a, BR_MSEC(10));
+
+    br_uart_puts("Test 5: timed out with ");
+    put_u32((uint32_t)a);
+    br_uart_puts(" of 3");
+    if (err == BR_ERR_TIMEOUT && a == 2 && in_sequence(in, 2, 500) &&
+        br_mqueue_recv_n(&mq, in, 2, 3, NULL, 0) == BR_ERR_INVALID &&
+        br_mqueue_send_n(&mq, out, 0, 0, NULL, 0) == BR_ERR_INVALID) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    br_uart_puts("\n=== Batched Message Queue Test Complete ===\n");
+
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_mqueue_init(&mq, mq_storage, sizeof(uint32_t), CAPACITY);
+    br_sem_init(&park, 0, 1);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+
+    br_kernel_start();
+}
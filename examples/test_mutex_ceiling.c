@@ -0,0 +1,142 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Priority-ceiling mutex test.
+ *
+ * Test 1: a low-priority task holding a ceiling mutex wakes a
+ *         medium-priority task; the medium task must not run until the
+ *         mutex is unlocked, and must run right at the unlock.
+ * Test 2: the same sequence with an ordinary mutex lets the medium task
+ *         preempt the owner at once.
+ * Test 3: br_mutex_init_ceiling() rejects a ceiling outside the
+ *         configured priority range.
+ */
+
+#include "bedrock/bedrock.h"
+
+extern void br_uart_puts(const char *s);
+
+#define PRIO_SUPERVISOR  1
+#define PRIO_CEILING     2
+#define PRIO_MEDIUM      3
+#define PRIO_LOW         4
+
+static uint8_t stack_supervisor[1024];
+static uint8_t stack_low[1024];
+static uint8_t stack_medium[1024];
+
+static br_mutex_t ceiling_mtx;
+static br_mutex_t plain_mtx;
+static br_sem_t   wake_medium;
+static br_sem_t   round_done;
+static br_sem_t   start_low;
+
+static br_mutex_t *volatile round_mtx;
+
+/* One round: 'l' locked, 'g' medium woken, 'm' medium ran, 'u' unlocked */
+static char trace[8];
+static int  trace_len;
+
+static void low_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        br_sem_take(&start_low, BR_TIME_INFINITE);
+
+        br_mutex_lock(round_mtx, BR_TIME_INFINITE);
+        trace[trace_len++] = 'l';
+        br_sem_give(&wake_medium);
+        trace[trace_len++] = 'g';
+        br_mutex_unlock(round_mtx);
+        trace[trace_len++] = 'u';
+
+        br_sem_give(&round_done);
+    }
+}
+
+static void medium_task(void *arg)
+{
+    (void)arg;
+
+    while (1) {
+        br_sem_take(&wake_medium, BR_TIME_INFINITE);
+        trace[trace_len++] = 'm';
+    }
+}
+
+/* Run one round with the given mutex and check the trace */
+static void run_round(const char *label, br_mutex_t *mtx, const char *expect)
+{
+    round_mtx = mtx;
+    trace_len = 0;
+    for (int i = 0; i < (int)sizeof(trace); i++) {
+        trace[i] = '\0';
+    }
+
+    br_sem_give(&start_low);
+    br_sem_take(&round_done, BR_TIME_INFINITE);
+
+    br_uart_puts(label);
+    br_uart_puts(trace);
+    bool ok = true;
+    for (int i = 0; expect[i] != '\0' || trace[i] != '\0'; i++) {
+        if (expect[i] != trace[i]) {
+            ok = false;
+            break;
+        }
+    }
+    br_uart_puts(ok ? " - PASS\n" : " - FAIL\n");
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_uart_puts("\n=== Mutex Ceiling Test ===\n\n");
+
+    run_round("Test 1: ceiling mutex trace ", &ceiling_mtx, "lgmu");
+    run_round("Test 2: plain mutex trace ", &plain_mtx, "lmgu");
+
+    br_mutex_t bad;
+    br_uart_puts(br_mutex_init_ceiling(&bad, CONFIG_NUM_PRIORITIES) ==
+                 BR_ERR_INVALID ? "Test 3: invalid ceiling rejected - PASS\n"
+                                : "Test 3: invalid ceiling accepted - FAIL\n");
+
+    br_uart_puts("\n=== Mutex Ceiling Test Complete ===\n");
+
+    while (1) {
+        br_sleep_ms(1000);
+    }
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_mutex_init_ceiling(&ceiling_mtx, PRIO_CEILING);
+    br_mutex_init(&plain_mtx);
+    br_sem_init(&wake_medium, 0, 1);
+    br_sem_init(&round_done, 0, 1);
+    br_sem_init(&start_low, 0, 1);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   PRIO_SUPERVISOR, stack_supervisor, sizeof(stack_supervisor));
+    br_task_create(NULL, "medium", medium_task, NULL,
+                   PRIO_MEDIUM, stack_medium, sizeof(stack_medium));
+    br_task_create(NULL, "low", low_task, NULL,
+                   PRIO_LOW, stack_low, sizeof(stack_low));
+
+    br_kernel_start();
+}
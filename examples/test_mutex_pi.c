@@ -0,0 +1,235 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Priority inheritance test: nested and chained mutexes.
+ *
+ * A medium-priority task is woken while a low-priority owner runs with
+ * an inherited priority; it must only get the CPU once nothing justifies
+ * the boost any more.
+ *
+ * Test 1: the owner of two mutexes keeps the boost from the contended
+ *         one when it unlocks the other.
+ * Test 2: inheritance follows a chain: high blocks on a mutex held by a
+ *         task that is itself blocked on a mutex held by low.
+ * Test 3: the boost is withdrawn when the waiter times out.
+ */
+
+#include "bedrock/bedrock.h"
+
+extern void br_uart_puts(const char *s);
+
+#define PRIO_SUPERVISOR  0
+#define PRIO_HIGH        1
+#define PRIO_MEDIUM      3
+#define PRIO_CHAIN       4
+#define PRIO_LOW         5
+
+#define HOLD_MS          50U
+#define WAIT_MS          20U
+
+static uint8_t stack_supervisor[1024];
+static uint8_t stack_medium[1024];
+static uint8_t stack_test[3][3][1024];
+
+static br_mutex_t mtx_a;
+static br_mutex_t mtx_b;
+static br_sem_t   wake_medium;
+static br_sem_t   go_high;
+static br_sem_t   go_chain;
+static br_sem_t   test_done;
+static br_sem_t   park;              /* Never given */
+
+static char trace[8];
+static int  trace_len;
+
+static void mark(char c)
+{
+    trace[trace_len++] = c;
+}
+
+static void medium_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        br_sem_take(&wake_medium, BR_TIME_INFINITE);
+        mark('m');
+    }
+}
+
+/* Take mtx_a, then mtx_b, and finish once mtx_a has been released */
+static void high_ab_task(void *arg)
+{
+    br_mutex_t *mtx = (br_mutex_t *)arg;
+
+    br_sem_take(&go_high, BR_TIME_INFINITE);
+    br_mutex_lock(mtx, BR_TIME_INFINITE);
+    mark('h');
+    br_mutex_unlock(mtx);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+/* Test 1 */
+
+static void nested_low_task(void *arg)
+{
+    (void)arg;
+
+    br_mutex_lock(&mtx_a, BR_TIME_INFINITE);
+    br_mutex_lock(&mtx_b, BR_TIME_INFINITE);
+    br_sem_give(&go_high);               /* High blocks on mtx_a */
+
+    br_sem_give(&wake_medium);
+    br_mutex_unlock(&mtx_b);
+    mark('b');
+    br_mutex_unlock(&mtx_a);
+    mark('a');
+
+    br_sem_give(&test_done);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+/* Test 2 */
+
+static void chain_task(void *arg)
+{
+    (void)arg;
+
+    br_sem_take(&go_chain, BR_TIME_INFINITE);
+    br_mutex_lock(&mtx_b, BR_TIME_INFINITE);
+    br_mutex_lock(&mtx_a, BR_TIME_INFINITE);  /* Blocks on low */
+    mark('x');
+    br_mutex_unlock(&mtx_a);
+    br_mutex_unlock(&mtx_b);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void chain_low_task(void *arg)
+{
+    (void)arg;
+
+    br_mutex_lock(&mtx_a, BR_TIME_INFINITE);
+    br_sem_give(&go_chain);              /* Chain takes mtx_b, blocks on mtx_a */
+    br_sem_give(&go_high);               /* High blocks on mtx_b */
+
+    br_sem_give(&wake_medium);
+    mark('l');
+    br_mutex_unlock(&mtx_a);
+
+    br_sem_give(&test_done);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+/* Test 3 */
+
+static void timeout_high_task(void *arg)
+{
+    (void)arg;
+
+    br_sem_take(&go_high, BR_TIME_INFINITE);
+    if (br_mutex_lock(&mtx_a, BR_MSEC(WAIT_MS)) == BR_ERR_TIMEOUT) {
+        mark('t');
+    }
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void timeout_low_task(void *arg)
+{
+    (void)arg;
+
+    br_mutex_lock(&mtx_a, BR_TIME_INFINITE);
+    br_sem_give(&go_high);               /* High waits WAIT_MS for mtx_a */
+
+    br_sem_give(&wake_medium);
+    br_time_t end = br_uptime_us() + BR_MSEC(HOLD_MS);
+    while (br_uptime_us() < end) { }
+    mark('l');
+    br_mutex_unlock(&mtx_a);
+
+    br_sem_give(&test_done);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void spawn(int test, int slot, br_task_entry_t entry, void *arg,
+                  uint8_t priority)
+{
+    br_task_create(NULL, "pi", entry, arg, priority,
+                   stack_test[test][slot], sizeof(stack_test[test][slot]));
+}
+
+/* Wait for a test to finish, give trailing tasks time to run, check */
+static void check(const char *label, const char *expect)
+{
+    br_sem_take(&test_done, BR_TIME_INFINITE);
+    br_sleep_ms(10);
+
+    br_uart_puts(label);
+    br_uart_puts(trace);
+    bool ok = true;
+    for (int i = 0; expect[i] != '\0' || trace[i] != '\0'; i++) {
+        if (expect[i] != trace[i]) {
+            ok = false;
+            break;
+        }
+    }
+    br_uart_puts(ok ? " - PASS\n" : " - FAIL\n");
+
+    trace_len = 0;
+    for (int i = 0; i < (int)sizeof(trace); i++) {
+        trace[i] = '\0';
+    }
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_uart_puts("\n=== Priority Inheritance Test ===\n\n");
+
+    spawn(0, 0, high_ab_task, &mtx_a, PRIO_HIGH);
+    spawn(0, 1, nested_low_task, NULL, PRIO_LOW);
+    check("Test 1: nested unlock trace ", "bhma");
+
+    spawn(1, 0, high_ab_task, &mtx_b, PRIO_HIGH);
+    spawn(1, 1, chain_task, NULL, PRIO_CHAIN);
+    spawn(1, 2, chain_low_task, NULL, PRIO_LOW);
+    check("Test 2: chained inheritance trace ", "lxhm");
+
+    spawn(2, 0, timeout_high_task, NULL, PRIO_HIGH);
+    spawn(2, 1, timeout_low_task, NULL, PRIO_LOW);
+    check("Test 3: waiter timeout trace ", "tml");
+
+    br_uart_puts("\n=== Priority Inheritance Test Complete ===\n");
+
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_mutex_init(&mtx_a);
+    br_mutex_init(&mtx_b);
+    br_sem_init(&wake_medium, 0, 1);
+    br_sem_init(&go_high, 0, 1);
+    br_sem_init(&go_chain, 0, 1);
+    br_sem_init(&test_done, 0, 1);
+    br_sem_init(&park, 0, 1);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   PRIO_SUPERVISOR, stack_supervisor, sizeof(stack_supervisor));
+    br_task_create(NULL, "medium", medium_task, NULL,
+                   PRIO_MEDIUM, stack_medium, sizeof(stack_medium));
+
+    br_kernel_start();
+}
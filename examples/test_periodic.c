@@ -0,0 +1,126 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Periodic release test.
+ *
+ * Test 1: br_sleep_until() wakes at the requested absolute time.
+ * Test 2: a 1 kHz loop with varying work runs LOOPS releases without
+ *         drifting, and its jitter statistics add up.
+ * Test 3: a job running past its next release is counted as an overrun,
+ *         and the schedule stays on its time grid.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#define PERIOD_US      1000U
+#define LOOPS          200U
+#define LATENESS_US    2000U
+
+static uint8_t stack_supervisor[2048];
+
+static void busy_us(br_time_t us)
+{
+    br_time_t end = br_uptime_us() + us;
+    while (br_uptime_us() < end) { }
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_uart_puts("\n=== Periodic Release Test ===\n\n");
+
+    /* Test 1: absolute sleep */
+    br_time_t target = br_uptime_us() + BR_MSEC(15);
+    br_sleep_until(target);
+    br_time_t late = br_uptime_us() - target;
+    br_uart_puts("Test 1: br_sleep_until woke ");
+    put_u32((uint32_t)late);
+    br_uart_puts(" us late");
+    br_uart_puts(late <= LATENESS_US ? " - PASS\n" : " - FAIL\n");
+
+    /* Test 2: drift-free 1 kHz loop, work of 0..300 us per job */
+    br_periodic_t loop;
+    br_periodic_init(&loop, PERIOD_US);
+    br_time_t start = loop.release;
+    uint32_t errors = 0;
+
+    for (uint32_t i = 0; i < LOOPS; i++) {
+        busy_us((i * 37U) % 300U);
+        if (br_periodic_wait(&loop) != BR_OK) {
+            errors++;
+        }
+    }
+    br_time_t end = br_uptime_us();
+
+    uint32_t binned = 0;
+    for (int i = 0; i < BR_PERIODIC_HIST_BINS; i++) {
+        binned += loop.jitter_hist[i];
+    }
+
+    br_uart_puts("Test 2: ");
+    put_u32(loop.releases);
+    br_uart_puts(" releases, ");
+    put_u32(loop.overruns);
+    br_uart_puts(" overruns, jitter ");
+    put_u32((uint32_t)loop.jitter_min);
+    br_uart_puts("..");
+    put_u32((uint32_t)loop.jitter_max);
+    br_uart_puts(" us");
+    if (errors == 0 && loop.releases == LOOPS && loop.overruns == 0 &&
+        binned == LOOPS && loop.jitter_max <= LATENESS_US &&
+        loop.release == start + (br_time_t)LOOPS * PERIOD_US &&
+        end - loop.release <= LATENESS_US) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 3: one job takes two and a half periods */
+    br_periodic_init(&loop, PERIOD_US);
+    start = loop.release;
+    br_periodic_wait(&loop);
+    busy_us(PERIOD_US * 5U / 2U);
+    br_err_t err = br_periodic_wait(&loop);
+    br_time_t phase = (loop.release - start) % PERIOD_US;
+    br_periodic_wait(&loop);
+
+    br_uart_puts("Test 3: overrun ");
+    br_uart_puts(err == BR_ERR_TIMEOUT ? "reported" : "not reported");
+    br_uart_puts(", overruns = ");
+    put_u32(loop.overruns);
+    if (err == BR_ERR_TIMEOUT && loop.overruns == 1 && loop.releases == 2 &&
+        phase == 0) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    br_uart_puts("\n=== Periodic Release Test Complete ===\n");
+
+    while (1) {
+        br_sleep_ms(1000);
+    }
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+
+    br_kernel_start();
+}
@@ -0,0 +1,150 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Idle governor test (requires CONFIG_PM).  Runs against the host HAL's
+ * mock power states: "wait" (no latency), "sleep" (100 us in, 400 us out)
+ * and "deep" (500 us in, 2000 us out).
+ *
+ * Test 1: long sleeps are spent in the deepest state, and still end on
+ *         time although leaving it takes 2 ms.
+ * Test 2: sleeps too short for "deep" use "sleep", on time.
+ * Test 3: sleeps too short for either only wait.
+ * Test 4: the state table is reported, and unknown states rejected.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#if !CONFIG_PM
+#error "test_power requires CONFIG_PM"
+#endif
+
+#define STATE_WAIT     0U
+#define STATE_SLEEP    1U
+#define STATE_DEEP     2U
+
+#define ROUNDS         5U
+#define LATENESS_US    1000U
+
+static uint8_t stack_supervisor[1024];
+
+static uint32_t entries(uint32_t state)
+{
+    br_power_stats_t st;
+    if (br_power_get_stats(state, &st) != BR_OK) {
+        return 0;
+    }
+    return st.entries;
+}
+
+/*
+ * Sleep ROUNDS times for `us`; returns the worst lateness and stores in
+ * used[] how often each state was entered meanwhile.
+ */
+static br_time_t sleep_rounds(br_time_t us, uint32_t used[3])
+{
+    uint32_t before[3];
+    for (uint32_t s = 0; s < 3; s++) {
+        before[s] = entries(s);
+    }
+
+    br_time_t worst = 0;
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        br_time_t start = br_uptime_us();
+        br_sleep_us(us);
+        br_time_t late = br_uptime_us() - start - us;
+        if (late > worst) {
+            worst = late;
+        }
+    }
+
+    for (uint32_t s = 0; s < 3; s++) {
+        used[s] = entries(s) - before[s];
+    }
+    return worst;
+}
+
+static void report(const char *what, uint32_t used[3], br_time_t worst,
+                   bool pass)
+{
+    br_uart_puts(what);
+    br_uart_puts(": wait ");
+    put_u32(used[STATE_WAIT]);
+    br_uart_puts(", sleep ");
+    put_u32(used[STATE_SLEEP]);
+    br_uart_puts(", deep ");
+    put_u32(used[STATE_DEEP]);
+    br_uart_puts(", worst lateness ");
+    put_u32((uint32_t)worst);
+    br_uart_puts(" us");
+    br_uart_puts(pass ? " - PASS\n" : " - FAIL\n");
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+    uint32_t used[3];
+    br_time_t worst;
+
+    br_uart_puts("\n=== Idle Governor Test ===\n\n");
+
+    /* Test 1: 20 ms leaves room for "deep" (2.5 ms) */
+    worst = sleep_rounds(BR_MSEC(20), used);
+    report("Test 1: 20 ms sleeps", used, worst,
+           used[STATE_DEEP] == ROUNDS && worst <= LATENESS_US);
+
+    /* Test 2: 1.5 ms fits "sleep" (0.5 ms) but not "deep" */
+    worst = sleep_rounds(1500U, used);
+    report("Test 2: 1.5 ms sleeps", used, worst,
+           used[STATE_DEEP] == 0 && used[STATE_SLEEP] == ROUNDS &&
+           worst <= LATENESS_US);
+
+    /* Test 3: 300 us fits neither */
+    worst = sleep_rounds(300U, used);
+    report("Test 3: 300 us sleeps", used, worst,
+           used[STATE_DEEP] == 0 && used[STATE_SLEEP] == 0 &&
+           used[STATE_WAIT] >= ROUNDS && worst <= LATENESS_US);
+
+    /* Test 4: the table */
+    br_power_stats_t st;
+    br_err_t deep = br_power_get_stats(STATE_DEEP, &st);
+    br_uart_puts("Test 4: ");
+    put_u32(br_power_state_count());
+    br_uart_puts(" states, deepest \"");
+    br_uart_puts(deep == BR_OK ? st.name : "?");
+    br_uart_puts("\"");
+    if (br_power_state_count() == 3 && deep == BR_OK &&
+        st.exit_latency == 2000U && st.residency >= BR_MSEC(ROUNDS * 15U) &&
+        br_power_get_stats(3, &st) == BR_ERR_INVALID) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    br_uart_puts("\n=== Idle Governor Test Complete ===\n");
+
+    while (1) {
+        br_sleep_ms(1000);
+    }
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+
+    br_kernel_start();
+}
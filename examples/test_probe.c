@@ -0,0 +1,170 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Cycle counter and probe test (requires CONFIG_PROBES and CONFIG_TIMERS).
+ *
+ * Test 1: br_cycles_now() counts at the rate of br_uptime_us().
+ * Test 2: a probe around REGIONS busy loops of WORK_US records each of
+ *         them, with consistent min, max, mean and histogram.
+ * Test 3: a probe in a BR_TIMER_ISR callback records from the alarm
+ *         interrupt.
+ * Test 4: br_probe_reset() clears a probe, and IDs past
+ *         CONFIG_PROBE_COUNT are rejected.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#if !CONFIG_PROBES || !CONFIG_TIMERS
+#error "test_probe requires CONFIG_PROBES and CONFIG_TIMERS"
+#endif
+
+#define PROBE_WORK     0
+#define PROBE_ISR      1
+
+#define SLEEP_MS       20U
+#define REGIONS        50U
+#define WORK_US        100U
+#define PERIOD_MS      5U
+#define PERIODS        10U
+#define SKEW_US        100U
+
+static uint8_t stack_supervisor[1024];
+
+static br_timer_t periodic;
+static volatile uint32_t isr_calls;
+
+/* Spins at least `us` - 1 us, as br_uptime_us() rounds down */
+static void busy_us(br_time_t us)
+{
+    br_time_t end = br_uptime_us() + us;
+    while (br_uptime_us() < end) { }
+}
+
+static void periodic_cb(br_timer_t *timer, void *arg)
+{
+    (void)timer;
+    (void)arg;
+
+    BR_PROBE_BEGIN(PROBE_ISR);
+    isr_calls++;
+    BR_PROBE_END(PROBE_ISR);
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_uart_puts("\n=== Cycle Counter and Probe Test ===\n\n");
+
+    /* Test 1: cycle rate */
+    br_time_t   up0  = br_uptime_us();
+    br_cycles_t cyc0 = br_cycles_now();
+    br_sleep_ms(SLEEP_MS);
+    br_cycles_t cyc1 = br_cycles_now();
+    br_time_t   up1  = br_uptime_us();
+
+    br_time_t cyc_us = br_cycles_to_ns(cyc1 - cyc0) / 1000U;
+    br_time_t up_us  = up1 - up0;
+    br_uart_puts("Test 1: ");
+    put_u32((uint32_t)cyc_us);
+    br_uart_puts(" us of cycles over ");
+    put_u32((uint32_t)up_us);
+    br_uart_puts(" us of uptime");
+    if (up_us >= BR_MSEC(SLEEP_MS) && cyc_us <= up_us &&
+        cyc_us + SKEW_US >= up_us) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 2: statistics of a task-level probe */
+    for (uint32_t i = 0; i < REGIONS; i++) {
+        BR_PROBE_BEGIN(PROBE_WORK);
+        busy_us(WORK_US);
+        BR_PROBE_END(PROBE_WORK);
+    }
+
+    br_probe_t p;
+    br_probe_read(PROBE_WORK, &p);
+    uint32_t binned = 0;
+    for (int i = 0; i < BR_PROBE_HIST_BINS; i++) {
+        binned += p.hist[i];
+    }
+    uint64_t mean = p.total / (p.count ? p.count : 1U);
+    uint32_t min_bin = 32U - (uint32_t)__builtin_clz(p.min ? p.min : 1U);
+
+    br_uart_puts("Test 2: ");
+    put_u32(p.count);
+    br_uart_puts(" regions, ");
+    put_u32((uint32_t)(br_cycles_to_ns(p.min) / 1000U));
+    br_uart_puts("..");
+    put_u32((uint32_t)(br_cycles_to_ns(p.max) / 1000U));
+    br_uart_puts(" us");
+    if (p.count == REGIONS && binned == REGIONS &&
+        br_cycles_to_ns(p.min) >= (WORK_US - 1U) * 1000U &&
+        p.min <= mean && mean <= p.max && p.hist[min_bin] != 0) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 3: probe in interrupt context */
+    br_timer_start(&periodic, BR_MSEC(PERIOD_MS), BR_MSEC(PERIOD_MS));
+    br_sleep_us(BR_MSEC(PERIODS * PERIOD_MS) + BR_MSEC(PERIOD_MS) / 2U);
+    br_timer_stop(&periodic);
+
+    br_probe_read(PROBE_ISR, &p);
+    br_uart_puts("Test 3: ISR probe recorded ");
+    put_u32(p.count);
+    br_uart_puts(" of ");
+    put_u32(isr_calls);
+    br_uart_puts(" callbacks");
+    if (p.count == isr_calls && p.count == PERIODS) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 4: reset and bad IDs */
+    br_probe_reset(PROBE_WORK);
+    br_probe_record(CONFIG_PROBE_COUNT, 1);
+    br_probe_read(PROBE_WORK, &p);
+    br_uart_puts("Test 4: reset ");
+    if (p.count == 0 && p.total == 0 && p.max == 0 &&
+        br_probe_read(CONFIG_PROBE_COUNT, &p) == BR_ERR_INVALID &&
+        br_probe_reset(CONFIG_PROBE_COUNT) == BR_ERR_INVALID) {
+        br_uart_puts("cleared, bad IDs rejected - PASS\n");
+    } else {
+        br_uart_puts("- FAIL\n");
+    }
+
+    br_uart_puts("\n=== Cycle Counter and Probe Test Complete ===\n");
+
+    while (1) {
+        br_sleep_ms(1000);
+    }
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_timer_init(&periodic, periodic_cb, NULL, BR_TIMER_ISR);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   2, stack_supervisor, sizeof(stack_supervisor));
+
+    br_kernel_start();
+}
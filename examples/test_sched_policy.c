@@ -0,0 +1,210 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Per-task scheduling policy test.
+ *
+ * Test 1: two BR_POLICY_FIFO tasks of equal priority, each busy for
+ *         several time slices, run one after the other.
+ * Test 2: two BR_POLICY_RR tasks of equal priority with slices of
+ *         SLICE_SHORT_MS and SLICE_LONG_MS share the CPU in about that
+ *         ratio.
+ * Test 3: two BR_POLICY_FIFO tasks of equal priority, repeatedly
+ *         preempted by a higher-priority ticker, still run one after the
+ *         other: a preempted FIFO task resumes ahead of its peers.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#define FIFO_WORK_MS     50U
+#define SLICE_SHORT_MS   10U
+#define SLICE_LONG_MS    30U
+#define RR_TEST_TIME_MS  600U
+#define TICK_MS          5U
+
+static uint8_t stack_supervisor[1024];
+static uint8_t stack_fifo[4][1024];
+static uint8_t stack_ticker[1024];
+static uint8_t stack_rr[2][1024];
+
+static br_sem_t park;                 /* Never given */
+static br_sem_t fifo_done;
+
+/* Tests 1 and 3: start and end of each FIFO task, e.g. "AaBb" */
+static char     fifo_trace[5];
+static int      fifo_trace_len;
+
+/* Test 2 */
+static volatile bool      rr_stop;
+static volatile br_time_t rr_run_us[2];
+
+/* Test 3 */
+static volatile bool      ticker_stop;
+static volatile uint32_t  ticks;
+
+static void fifo_task(void *arg)
+{
+    char name = (char)(uintptr_t)arg;
+
+    fifo_trace[fifo_trace_len++] = name;
+    br_time_t end = br_uptime_us() + BR_MSEC(FIFO_WORK_MS);
+    while (br_uptime_us() < end) { }
+    fifo_trace[fifo_trace_len++] = (char)(name - 'A' + 'a');
+
+    br_sem_give(&fifo_done);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+/* Add up the time this task was on the CPU until told to stop: gaps
+ * between two samples longer than a few hundred microseconds mean the
+ * task was switched out */
+static void rr_task(void *arg)
+{
+    volatile br_time_t *run_us = &rr_run_us[(uintptr_t)arg];
+    br_time_t last = br_uptime_us();
+
+    while (!rr_stop) {
+        br_time_t now = br_uptime_us();
+        if (now - last < 500U) {
+            *run_us += now - last;
+        }
+        last = now;
+    }
+
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+/* Higher priority than the workers: preempts them every TICK_MS */
+static void ticker_task(void *arg)
+{
+    (void)arg;
+    while (!ticker_stop) {
+        br_sleep_ms(TICK_MS);
+        ticks++;
+    }
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+/* The trace shows task `first` run to completion, then the next one */
+static bool fifo_in_order(char first)
+{
+    char second = (char)(first + 1);
+    return fifo_trace_len == 4 &&
+           fifo_trace[0] == first  && fifo_trace[1] == first - 'A' + 'a' &&
+           fifo_trace[2] == second && fifo_trace[3] == second - 'A' + 'a';
+}
+
+static void create_worker(br_sched_policy_t policy, uint32_t slice_ms,
+                          br_task_entry_t entry, void *arg,
+                          uint8_t *stack, size_t stack_size)
+{
+    br_task_attr_t attr;
+    br_task_attr_init(&attr);
+    attr.name       = "worker";
+    attr.priority   = 2;
+    attr.policy     = policy;
+    attr.time_slice = BR_MSEC(slice_ms);
+
+    br_task_create_attr(NULL, &attr, entry, arg, stack, stack_size);
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_uart_puts("\n=== Scheduling Policy Test ===\n\n");
+
+    /* Test 1: FIFO tasks are not time-sliced */
+    create_worker(BR_POLICY_FIFO, 0, fifo_task, (void *)(uintptr_t)'A',
+                  stack_fifo[0], sizeof(stack_fifo[0]));
+    create_worker(BR_POLICY_FIFO, 0, fifo_task, (void *)(uintptr_t)'B',
+                  stack_fifo[1], sizeof(stack_fifo[1]));
+    br_sem_take(&fifo_done, BR_TIME_INFINITE);
+    br_sem_take(&fifo_done, BR_TIME_INFINITE);
+
+    br_uart_puts("Test 1: FIFO trace ");
+    br_uart_puts(fifo_trace);
+    if (fifo_in_order('A')) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 2: round-robin tasks with their own slice lengths */
+    create_worker(BR_POLICY_RR, SLICE_SHORT_MS, rr_task, (void *)0,
+                  stack_rr[0], sizeof(stack_rr[0]));
+    create_worker(BR_POLICY_RR, SLICE_LONG_MS, rr_task, (void *)1,
+                  stack_rr[1], sizeof(stack_rr[1]));
+    br_sleep_ms(RR_TEST_TIME_MS);
+    rr_stop = true;
+
+    uint32_t short_ms = (uint32_t)(rr_run_us[0] / 1000U);
+    uint32_t long_ms  = (uint32_t)(rr_run_us[1] / 1000U);
+
+    br_uart_puts("Test 2: ");
+    put_u32(SLICE_SHORT_MS);
+    br_uart_puts(" ms slice ran ");
+    put_u32(short_ms);
+    br_uart_puts(" ms, ");
+    put_u32(SLICE_LONG_MS);
+    br_uart_puts(" ms slice ran ");
+    put_u32(long_ms);
+    br_uart_puts(" ms");
+    /* Expect SLICE_LONG_MS / SLICE_SHORT_MS = 3, allow 2..4 */
+    if (short_ms > 0 && long_ms >= 2U * short_ms && long_ms <= 4U * short_ms) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 3: FIFO order survives preemption from above */
+    fifo_trace_len = 0;
+    br_task_create(NULL, "ticker", ticker_task, NULL, 1,
+                   stack_ticker, sizeof(stack_ticker));
+    create_worker(BR_POLICY_FIFO, 0, fifo_task, (void *)(uintptr_t)'C',
+                  stack_fifo[2], sizeof(stack_fifo[2]));
+    create_worker(BR_POLICY_FIFO, 0, fifo_task, (void *)(uintptr_t)'D',
+                  stack_fifo[3], sizeof(stack_fifo[3]));
+    br_sem_take(&fifo_done, BR_TIME_INFINITE);
+    br_sem_take(&fifo_done, BR_TIME_INFINITE);
+    ticker_stop = true;
+
+    br_uart_puts("Test 3: FIFO trace ");
+    br_uart_puts(fifo_trace);
+    br_uart_puts(" across ");
+    put_u32(ticks);
+    br_uart_puts(" preemptions");
+    if (fifo_in_order('C') && ticks >= FIFO_WORK_MS / TICK_MS) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    br_uart_puts("\n=== Scheduling Policy Test Complete ===\n");
+
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_sem_init(&park, 0, 1);
+    br_sem_init(&fifo_done, 0, 2);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+
+    br_kernel_start();
+}
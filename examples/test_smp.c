@@ -0,0 +1,151 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * SMP test (host simulator built with CONFIG_SMP).
+ *
+ * Test 1: SMP_WORKERS tasks increment a shared counter under a mutex and
+ *         record which CPUs they ran on.  The final count must be exact
+ *         and the work must have been spread over more than one CPU.
+ * Test 2: two tasks ping-pong over a pair of semaphores, so every round
+ *         is a cross-CPU wakeup whenever the pair sits on different CPUs.
+ *
+ * Only the supervisor prints, and only while the other tasks are parked.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#define SMP_WORKERS       8
+#define SMP_ITERATIONS    5000U
+#define PINGPONG_ROUNDS   1000U
+
+static uint8_t stack_supervisor[1024];
+static uint8_t stack_worker[SMP_WORKERS][1024];
+static uint8_t stack_ping[1024];
+static uint8_t stack_pong[1024];
+
+static br_mutex_t counter_lock;
+static uint32_t   counter;
+static uint32_t   cpus_used;     /* Bit n set: some worker ran on CPU n */
+
+static br_sem_t   workers_done;
+static br_sem_t   ping_sem;
+static br_sem_t   pong_sem;
+static br_sem_t   pingpong_done;
+static br_sem_t   park;          /* Never given */
+
+static void worker_task(void *arg)
+{
+    (void)arg;
+
+    for (uint32_t i = 0; i < SMP_ITERATIONS; i++) {
+        br_mutex_lock(&counter_lock, BR_TIME_INFINITE);
+        counter++;
+        cpus_used |= 1UL << br_cpu_id();
+        br_mutex_unlock(&counter_lock);
+
+        /* Work outside the lock, so the CPUs really run in parallel */
+        for (volatile uint32_t spin = 0; spin < 1000U; spin++) { }
+    }
+
+    br_sem_give(&workers_done);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void ping_task(void *arg)
+{
+    (void)arg;
+
+    for (uint32_t i = 0; i < PINGPONG_ROUNDS; i++) {
+        br_sem_give(&ping_sem);
+        br_sem_take(&pong_sem, BR_TIME_INFINITE);
+    }
+
+    br_sem_give(&pingpong_done);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void pong_task(void *arg)
+{
+    (void)arg;
+
+    for (uint32_t i = 0; i < PINGPONG_ROUNDS; i++) {
+        br_sem_take(&ping_sem, BR_TIME_INFINITE);
+        br_sem_give(&pong_sem);
+    }
+
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_uart_puts("\n=== SMP Test (");
+    put_u32(CONFIG_NUM_CPUS);
+    br_uart_puts(" CPUs) ===\n\n");
+
+    /* Test 1: shared counter */
+    for (int i = 0; i < SMP_WORKERS; i++) {
+        br_task_create(NULL, "worker", worker_task, NULL, 2,
+                       stack_worker[i], sizeof(stack_worker[i]));
+    }
+    for (int i = 0; i < SMP_WORKERS; i++) {
+        br_sem_take(&workers_done, BR_TIME_INFINITE);
+    }
+
+    uint32_t ncpus = (uint32_t)__builtin_popcount(cpus_used);
+
+    br_uart_puts("Test 1: counter = ");
+    put_u32(counter);
+    br_uart_puts(", CPUs used = ");
+    put_u32(ncpus);
+    if (counter == SMP_WORKERS * SMP_ITERATIONS && ncpus > 1) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 2: cross-CPU semaphore ping-pong */
+    br_task_create(NULL, "pong", pong_task, NULL, 2,
+                   stack_pong, sizeof(stack_pong));
+    br_task_create(NULL, "ping", ping_task, NULL, 2,
+                   stack_ping, sizeof(stack_ping));
+    br_sem_take(&pingpong_done, BR_TIME_INFINITE);
+
+    br_uart_puts("Test 2: ");
+    put_u32(PINGPONG_ROUNDS);
+    br_uart_puts(" ping-pong rounds - PASS\n");
+
+    br_uart_puts("\n=== SMP Test Complete ===\n");
+
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_mutex_init(&counter_lock);
+    br_sem_init(&workers_done, 0, SMP_WORKERS);
+    br_sem_init(&ping_sem, 0, 1);
+    br_sem_init(&pong_sem, 0, 1);
+    br_sem_init(&pingpong_done, 0, 1);
+    br_sem_init(&park, 0, 1);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+
+    br_kernel_start();
+}
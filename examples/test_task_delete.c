@@ -23,6 +23,14 @@ static uint8_t stack_supervisor[1024];
 static uint8_t stack_worker[512];
 static uint8_t stack_test[512];
 
+/* Test 5: stacks carved at CHURN_STEP offsets, a different one each time */
+#define CHURN_ROUNDS    (4 * CONFIG_MAX_TASKS)
+#define CHURN_STEP      16U
+#define CHURN_STACK     512U
+static uint8_t churn_area[CHURN_ROUNDS * CHURN_STEP + CHURN_STACK]
+    __attribute__((aligned(16)));
+static volatile int churn_runs = 0;
+
 static volatile int worker_run_count = 0;
 static br_tid_t current_worker_tid = 0;
 
@@ -75,6 +83,15 @@ static void self_delete_task(void *arg)
     }
 }
 
+static void churn_task(void *arg)
+{
+    (void)arg;
+    churn_runs++;
+    while (1) {
+        br_sleep_ms(1000);
+    }
+}
+
 /* Supervisor task that creates, waits, and deletes workers */
 static void supervisor_task(void *arg)
 {
@@ -108,7 +125,7 @@ static void supervisor_task(void *arg)
         br_uart_puts("Test 1: FAIL - Could not delete worker 1\n\n");
     }
     
-    /* Test 2: Create worker 2 - should reuse same slot */
+    /* Test 2: Create worker 2 - reuses the slot under a new ID */
     br_uart_puts("Test 2: Create Worker 2 (should reuse slot)\n");
     br_tid_t worker2_tid;
     err = br_task_create(&worker2_tid, "worker2", worker_task,
@@ -118,15 +135,19 @@ static void supervisor_task(void *arg)
         while (1) { br_sleep_ms(1000); }
     }
     
+    /* Same slot, next generation: with the default CONFIG_MAX_TASKS of
+     * 16 the low 4 bits of the ID are the slot */
     br_uart_puts("Test 2: Worker TID = ");
-    if (worker2_tid == 2) br_uart_puts("2");
-    else if (worker2_tid == 3) br_uart_puts("3");
+    if ((worker2_tid & 0xF) == 2) br_uart_puts("slot 2");
+    else if ((worker2_tid & 0xF) == 3) br_uart_puts("slot 3");
     else br_uart_puts("?");
     
-    if (worker2_tid == current_worker_tid) {
-        br_uart_puts(" (REUSED - PASS)\n");
+    if ((worker2_tid & 0xF) == (current_worker_tid & 0xF) &&
+        worker2_tid != current_worker_tid &&
+        br_task_delete(current_worker_tid) == BR_ERR_INVALID) {
+        br_uart_puts(" (REUSED, STALE TID REJECTED - PASS)\n");
     } else {
-        br_uart_puts(" (NEW SLOT - FAIL)\n");
+        br_uart_puts(" (FAIL)\n");
     }
     
     br_sleep_ms(200);
@@ -159,6 +180,41 @@ static void supervisor_task(void *arg)
         br_uart_puts("FAIL\n");
     }
     
+    /* Test 5: task slots are reused.  The host HAL keeps each task's
+     * context in its own slot, so there the stack top is left alone;
+     * a target HAL builds its first frame right there. */
+    br_uart_puts("\nTest 5: Create and delete 4 x CONFIG_MAX_TASKS tasks\n");
+    int churn_ok = 0;
+    for (uint32_t i = 0; i < CHURN_ROUNDS; i++) {
+        uint8_t *stack = &churn_area[i * CHURN_STEP];
+#if defined(__x86_64__)
+        uint32_t *top = (uint32_t *)(stack + CHURN_STACK) - 2;
+        top[0] = 0xC0FFEEU;
+        top[1] = 0xC0FFEEU;
+#endif
+
+        br_tid_t churn_tid;
+        if (br_task_create(&churn_tid, "churn", churn_task, NULL, 3,
+                           stack, CHURN_STACK) != BR_OK) {
+            break;
+        }
+        br_sleep_ms(1);                      /* Let it run */
+        if (br_task_delete(churn_tid) != BR_OK) {
+            continue;
+        }
+#if defined(__x86_64__)
+        if (top[0] != 0xC0FFEEU || top[1] != 0xC0FFEEU) {
+            continue;
+        }
+#endif
+        churn_ok++;
+    }
+    if (churn_ok == CHURN_ROUNDS && churn_runs == CHURN_ROUNDS) {
+        br_uart_puts("Test 5: all ran and were deleted - PASS\n");
+    } else {
+        br_uart_puts("Test 5: FAIL\n");
+    }
+
     /* Summary */
     br_uart_puts("\n=== All Tests Complete ===\n");
     br_uart_puts("Task deletion working correctly!\n\n");
@@ -0,0 +1,177 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Task statistics test (requires CONFIG_TASK_STATS).
+ *
+ * A worker busy for WORK_MS then asleep for SLEEP_MS, ROUNDS times, runs
+ * above a low-priority CPU hog.
+ *
+ * Test 1: every sleep of the worker counts as a voluntary switch, and
+ *         nothing preempts it.
+ * Test 2: every wakeup of the worker preempts the hog.
+ * Test 3: the worker's runtime is about ROUNDS * WORK_MS, the hog's
+ *         about the rest of the time.
+ * Test 4: an unused task ID is rejected.
+ * Test 5: (CONFIG_SCHED_BUDGET) a spinner beside the hog with a small
+ *         budget is throttled every period; each throttle counts as a
+ *         preemption, never as a voluntary switch.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#if !CONFIG_TASK_STATS
+#error "test_task_stats requires CONFIG_TASK_STATS"
+#endif
+
+#define ROUNDS        20U
+#define WORK_MS       1U
+#define SLEEP_MS      10U
+#define TEST_TIME_MS  400U
+#define BUDGET_MS     1U
+#define PERIOD_MS     20U
+
+static uint8_t stack_supervisor[1024];
+static uint8_t stack_worker[1024];
+static uint8_t stack_hog[1024];
+#if CONFIG_SCHED_BUDGET
+static uint8_t stack_capped[1024];
+static br_tid_t capped_tid;
+static br_budget_t capped_budget;
+#endif
+
+static br_tid_t worker_tid;
+static br_tid_t hog_tid;
+static br_sem_t park;                 /* Never given */
+
+static void worker_task(void *arg)
+{
+    (void)arg;
+
+    for (uint32_t i = 0; i < ROUNDS; i++) {
+        br_time_t end = br_uptime_us() + BR_MSEC(WORK_MS);
+        while (br_uptime_us() < end) { }
+        br_sleep_ms(SLEEP_MS);
+    }
+
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void hog_task(void *arg)
+{
+    (void)arg;
+    while (1) { }
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_sleep_ms(TEST_TIME_MS);
+
+    br_task_stats_t worker;
+    br_task_stats_t hog;
+    br_task_get_stats(worker_tid, &worker);
+    br_task_get_stats(hog_tid, &hog);
+
+    br_uart_puts("\n=== Task Statistics Test ===\n\n");
+
+    br_uart_puts("Test 1: worker voluntary = ");
+    put_u32(worker.voluntary);
+    br_uart_puts(", preemptions = ");
+    put_u32(worker.preemptions);
+    /* ROUNDS sleeps plus the final park */
+    if (worker.voluntary == ROUNDS + 1U && worker.preemptions == 0 &&
+        worker.switches == worker.voluntary) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    br_uart_puts("Test 2: hog preemptions = ");
+    put_u32(hog.preemptions);
+    if (hog.preemptions >= ROUNDS) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    uint32_t worker_ms = (uint32_t)(worker.runtime / 1000U);
+    uint32_t hog_ms    = (uint32_t)(hog.runtime / 1000U);
+
+    br_uart_puts("Test 3: worker ran ");
+    put_u32(worker_ms);
+    br_uart_puts(" ms, hog ran ");
+    put_u32(hog_ms);
+    br_uart_puts(" ms");
+    if (worker_ms >= ROUNDS * WORK_MS && worker_ms <= 3U * ROUNDS * WORK_MS &&
+        hog_ms >= TEST_TIME_MS / 2) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    br_task_stats_t unused;
+    br_uart_puts(br_task_get_stats(CONFIG_MAX_TASKS - 1, &unused) ==
+                 BR_ERR_INVALID ? "Test 4: unused task rejected - PASS\n"
+                                : "Test 4: unused task accepted - FAIL\n");
+
+#if CONFIG_SCHED_BUDGET
+    br_task_stats_t capped;
+    br_task_get_stats(capped_tid, &capped);
+
+    br_uart_puts("Test 5: throttled voluntary = ");
+    put_u32(capped.voluntary);
+    br_uart_puts(", preemptions = ");
+    put_u32(capped.preemptions);
+    if (capped.voluntary == 0 &&
+        capped.preemptions >= TEST_TIME_MS / PERIOD_MS / 2U) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+#endif
+
+    br_uart_puts("\n=== Task Statistics Test Complete ===\n");
+
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_sem_init(&park, 0, 1);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+    br_task_create(&worker_tid, "worker", worker_task, NULL,
+                   2, stack_worker, sizeof(stack_worker));
+    br_task_create(&hog_tid, "hog", hog_task, NULL,
+                   3, stack_hog, sizeof(stack_hog));
+
+#if CONFIG_SCHED_BUDGET
+    br_budget_init(&capped_budget, BR_MSEC(BUDGET_MS), BR_MSEC(PERIOD_MS));
+
+    br_task_attr_t attr;
+    br_task_attr_init(&attr);
+    attr.name     = "capped";
+    attr.priority = 3;
+    attr.budget   = &capped_budget;
+    br_task_create_attr(&capped_tid, &attr, hog_task, NULL,
+                        stack_capped, sizeof(stack_capped));
+#endif
+
+    br_kernel_start();
+}
@@ -0,0 +1,184 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Timed wait test.
+ *
+ * Test 1: WAITERS tasks, created in shuffled order, wait on one semaphore
+ *         with different timeouts.  Each times out in deadline order and
+ *         close to its deadline.
+ * Test 2: a timed waiter times out while an untimed one waits on the same
+ *         semaphore; the wait queue stays intact and the next give wakes
+ *         the untimed waiter.
+ * Test 3: a timed waiter that is given the semaphore in time returns
+ *         BR_OK, and its cancelled timeout never fires later.
+ */
+
+#include "bedrock/bedrock.h"
+
+extern void br_uart_puts(const char *s);
+
+#define WAITERS        6
+#define TIMEOUT_MS     10U     /* Waiter i times out after (i + 1) * this */
+#define LATENESS_US    2000U
+
+static uint8_t stack_supervisor[1024];
+static uint8_t stack_waiter[WAITERS + 3][1024];
+
+/* Creation order, so the deadlines are not inserted sorted */
+static const uint8_t create_order[WAITERS] = { 3, 0, 5, 1, 4, 2 };
+
+static br_sem_t  never;          /* Test 1: never given */
+static br_sem_t  shared;         /* Test 2 */
+static br_sem_t  given;          /* Test 3 */
+static br_sem_t  done;
+static br_sem_t  park;           /* Never given */
+
+static char      trace[WAITERS + 1];
+static int       trace_len;
+static uint32_t  late;           /* Waiters that woke late or not timed out */
+
+static br_err_t  timed_result;
+static br_err_t  untimed_result;
+static br_err_t  cancel_result;
+static volatile bool stray_wakeup;
+
+static void waiter_task(void *arg)
+{
+    uint32_t idx = (uint32_t)(uintptr_t)arg;
+    br_time_t timeout = BR_MSEC((idx + 1U) * TIMEOUT_MS);
+    br_time_t start = br_uptime_us();
+
+    br_err_t err = br_sem_take(&never, timeout);
+    br_time_t waited = br_uptime_us() - start;
+
+    trace[trace_len++] = (char)('0' + idx);
+    if (err != BR_ERR_TIMEOUT || waited < timeout ||
+        waited > timeout + LATENESS_US) {
+        late++;
+    }
+
+    br_sem_give(&done);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void timed_task(void *arg)
+{
+    (void)arg;
+    timed_result = br_sem_take(&shared, BR_MSEC(20));
+    br_sem_give(&done);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void untimed_task(void *arg)
+{
+    (void)arg;
+    untimed_result = br_sem_take(&shared, BR_TIME_INFINITE);
+    br_sem_give(&done);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+static void cancel_task(void *arg)
+{
+    (void)arg;
+    cancel_result = br_sem_take(&given, BR_MSEC(30));
+
+    /* Only a timeout left behind can end this wait */
+    br_sem_give(&done);
+    br_sem_take(&park, BR_TIME_INFINITE);
+    stray_wakeup = true;
+}
+
+static void create(br_task_entry_t entry, uint32_t arg, int stack)
+{
+    br_task_create(NULL, "waiter", entry, (void *)(uintptr_t)arg, 2,
+                   stack_waiter[stack], sizeof(stack_waiter[stack]));
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_uart_puts("\n=== Timed Wait Test ===\n\n");
+
+    /* Test 1: timeouts expire in deadline order */
+    for (int i = 0; i < WAITERS; i++) {
+        create(waiter_task, create_order[i], i);
+    }
+    for (int i = 0; i < WAITERS; i++) {
+        br_sem_take(&done, BR_TIME_INFINITE);
+    }
+
+    br_uart_puts("Test 1: timeout order ");
+    br_uart_puts(trace);
+    if (trace_len == WAITERS && late == 0 &&
+        trace[0] == '0' && trace[1] == '1' && trace[2] == '2' &&
+        trace[3] == '3' && trace[4] == '4' && trace[5] == '5') {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 2: the Test 1 tasks stay parked, so use the spare stacks */
+    create(untimed_task, 0, WAITERS);
+    create(timed_task, 0, WAITERS + 1);
+    br_sem_take(&done, BR_TIME_INFINITE);    /* timed_task timed out */
+    br_sem_give(&shared);
+    br_sem_take(&done, BR_TIME_INFINITE);    /* untimed_task woken */
+
+    br_uart_puts("Test 2: timed waiter ");
+    br_uart_puts(timed_result == BR_ERR_TIMEOUT ? "timed out" : "did not time out");
+    br_uart_puts(", untimed waiter ");
+    br_uart_puts(untimed_result == BR_OK ? "woken" : "not woken");
+    if (timed_result == BR_ERR_TIMEOUT && untimed_result == BR_OK) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 3: a timeout cancelled by a give */
+    create(cancel_task, 0, WAITERS + 2);
+    br_sleep_ms(5);
+    br_sem_give(&given);
+    br_sem_take(&done, BR_TIME_INFINITE);
+    br_sleep_ms(60);                         /* Past the 30 ms timeout */
+
+    br_uart_puts("Test 3: given waiter ");
+    br_uart_puts(cancel_result == BR_OK ? "returned BR_OK" : "failed");
+    br_uart_puts(stray_wakeup ? ", stale timeout fired" : ", no stale timeout");
+    if (cancel_result == BR_OK && !stray_wakeup) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    br_uart_puts("\n=== Timed Wait Test Complete ===\n");
+
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_sem_init(&never, 0, 1);
+    br_sem_init(&shared, 0, 1);
+    br_sem_init(&given, 0, 1);
+    br_sem_init(&done, 0, WAITERS);
+    br_sem_init(&park, 0, 1);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+
+    br_kernel_start();
+}
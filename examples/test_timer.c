@@ -0,0 +1,192 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Software timer test (requires CONFIG_TIMERS).
+ *
+ * Test 1: a one-shot timer calls back once, on time, from the timer
+ *         service task.
+ * Test 2: a periodic BR_TIMER_ISR timer calls back from the alarm
+ *         interrupt once per period, without drifting.
+ * Test 3: a stopped timer, one-shot or periodic, calls back no more.
+ * Test 4: restarting a running timer moves its expiry.
+ */
+
+#include "bedrock/bedrock.h"
+#include "example_io.h"
+
+#if !CONFIG_TIMERS
+#error "test_timer requires CONFIG_TIMERS"
+#endif
+
+#define ONESHOT_MS     20U
+#define PERIOD_MS      10U
+#define PERIODS        20U
+#define LATENESS_US    2000U
+
+static uint8_t stack_supervisor[1024];
+
+static br_timer_t oneshot;
+static br_timer_t periodic;
+static br_sem_t   fired;
+
+typedef struct {
+    uint32_t  calls;
+    uint32_t  in_isr;          /* Calls made from interrupt context */
+    br_time_t first;
+    br_time_t last;
+} timer_log_t;
+
+static volatile timer_log_t oneshot_log;
+static volatile timer_log_t periodic_log;
+
+static void log_call(volatile timer_log_t *log)
+{
+    br_time_t now = br_uptime_us();
+
+    if (log->calls == 0) {
+        log->first = now;
+    }
+    log->last = now;
+    log->calls++;
+    if (br_hal_in_isr()) {
+        log->in_isr++;
+    }
+}
+
+static void oneshot_cb(br_timer_t *timer, void *arg)
+{
+    (void)timer;
+    (void)arg;
+    log_call(&oneshot_log);
+    br_sem_give(&fired);
+}
+
+static void periodic_cb(br_timer_t *timer, void *arg)
+{
+    (void)timer;
+    (void)arg;
+    log_call(&periodic_log);
+}
+
+static void reset_log(volatile timer_log_t *log)
+{
+    log->calls  = 0;
+    log->in_isr = 0;
+    log->first  = 0;
+    log->last   = 0;
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_uart_puts("\n=== Software Timer Test ===\n\n");
+
+    /* Test 1: one-shot, service task context */
+    br_time_t start = br_uptime_us();
+    br_timer_start(&oneshot, BR_MSEC(ONESHOT_MS), 0);
+    br_sem_take(&fired, BR_TIME_INFINITE);
+    br_sleep_ms(3U * ONESHOT_MS);
+
+    br_time_t delay = oneshot_log.first - start;
+    br_uart_puts("Test 1: one-shot fired ");
+    put_u32(oneshot_log.calls);
+    br_uart_puts(" time(s) after ");
+    put_u32((uint32_t)delay);
+    br_uart_puts(" us");
+    if (oneshot_log.calls == 1 && oneshot_log.in_isr == 0 &&
+        delay >= BR_MSEC(ONESHOT_MS) &&
+        delay <= BR_MSEC(ONESHOT_MS) + LATENESS_US) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 2: periodic, ISR context */
+    start = br_uptime_us();
+    br_timer_start(&periodic, BR_MSEC(PERIOD_MS), BR_MSEC(PERIOD_MS));
+    br_sleep_us(BR_MSEC(PERIODS * PERIOD_MS) + BR_MSEC(PERIOD_MS) / 2U);
+
+    uint32_t calls = periodic_log.calls;
+    br_time_t span = periodic_log.last - periodic_log.first;
+    br_time_t expect = BR_MSEC((calls - 1U) * PERIOD_MS);
+    br_uart_puts("Test 2: periodic fired ");
+    put_u32(calls);
+    br_uart_puts(" times, ");
+    put_u32(periodic_log.in_isr);
+    br_uart_puts(" in ISR, span ");
+    put_u32((uint32_t)span);
+    br_uart_puts(" us");
+    if (calls == PERIODS && periodic_log.in_isr == calls &&
+        periodic_log.first - start <= BR_MSEC(PERIOD_MS) + LATENESS_US &&
+        span + LATENESS_US >= expect && span <= expect + LATENESS_US) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    /* Test 3: stop both kinds */
+    br_timer_stop(&periodic);
+    calls = periodic_log.calls;
+    reset_log(&oneshot_log);
+    br_timer_start(&oneshot, BR_MSEC(ONESHOT_MS), 0);
+    br_sleep_ms(ONESHOT_MS / 2U);
+    br_timer_stop(&oneshot);
+    br_sleep_ms(3U * ONESHOT_MS);
+
+    br_uart_puts("Test 3: stopped timers ");
+    if (oneshot_log.calls == 0 && periodic_log.calls == calls) {
+        br_uart_puts("stayed quiet - PASS\n");
+    } else {
+        br_uart_puts("fired - FAIL\n");
+    }
+
+    /* Test 4: restart pushes the expiry back */
+    br_timer_start(&oneshot, BR_MSEC(ONESHOT_MS), 0);
+    br_sleep_ms(ONESHOT_MS / 2U);
+    br_time_t restart = br_uptime_us();
+    br_timer_start(&oneshot, BR_MSEC(ONESHOT_MS), 0);
+    br_sem_take(&fired, BR_TIME_INFINITE);
+
+    delay = oneshot_log.first - restart;
+    br_uart_puts("Test 4: restarted timer fired ");
+    put_u32((uint32_t)delay);
+    br_uart_puts(" us after the restart");
+    if (oneshot_log.calls == 1 && delay >= BR_MSEC(ONESHOT_MS) &&
+        delay <= BR_MSEC(ONESHOT_MS) + LATENESS_US) {
+        br_uart_puts(" - PASS\n");
+    } else {
+        br_uart_puts(" - FAIL\n");
+    }
+
+    br_uart_puts("\n=== Software Timer Test Complete ===\n");
+
+    while (1) {
+        br_sleep_ms(1000);
+    }
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_sem_init(&fired, 0, 1);
+    br_timer_init(&oneshot, oneshot_cb, NULL, 0);
+    br_timer_init(&periodic, periodic_cb, NULL, BR_TIMER_ISR);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   2, stack_supervisor, sizeof(stack_supervisor));
+
+    br_kernel_start();
+}
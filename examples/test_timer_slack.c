@@ -0,0 +1,167 @@
+/*
+ * Project: bedrock[RTOS]
+ * Version: 0.0.3
+ * Author:  AnmiTaliDev <anmitalidev@nuros.org>
+ * License: GPL-3.0-only WITH runtime exception
+ *
+ * SPDX-License-Identifier: GPL-3.0-only
+ *
+ * This file is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 3.
+ * Applications that link against or run on bedrock[RTOS] are NOT required
+ * to be GPL-licensed — only changes to bedrock[RTOS] itself must remain GPL.
+ * See LICENSE-GPL-3.0.md for the full terms and runtime exception.
+ *
+ * Timer slack test.
+ *
+ * SLEEPERS tasks sleep for SLEEP_MS + i * STEP_MS each.
+ *
+ * Test 1: with SLACK_MS of slack, more than the spread of the wake times,
+ *         they all wake together, each inside its own window.
+ * Test 2: without slack, each wakes on its own, on time.
+ * Test 3: a task created with br_task_attr_t.timer_slack has its timed
+ *         waits coalesced the same way.
+ */
+
+#include "bedrock/bedrock.h"
+
+extern void br_uart_puts(const char *s);
+
+#define SLEEPERS       4
+#define SLEEP_MS       10U
+#define STEP_MS        2U
+#define SLACK_MS       10U
+#define TOGETHER_US    500U     /* Spread of wake times woken in one pass */
+#define LATENESS_US    2000U
+
+static uint8_t stack_supervisor[1024];
+static uint8_t stack_sleeper[SLEEPERS][1024];
+
+static br_sem_t  done;
+static br_sem_t  never;         /* Never given: Test 3 waits time out */
+static br_sem_t  park;          /* Never given */
+
+static br_time_t slack_us;      /* Slack used by the current test */
+static bool      by_attr;       /* Test 3: timed waits, attribute slack */
+static br_tid_t  sleeper_tid[SLEEPERS];
+static br_time_t wake[SLEEPERS];
+static uint32_t  outside;       /* Wakeups outside their window */
+
+static void sleeper_task(void *arg)
+{
+    uint32_t idx = (uint32_t)(uintptr_t)arg;
+    br_time_t us = BR_MSEC(SLEEP_MS + idx * STEP_MS);
+    br_time_t start = br_uptime_us();
+
+    if (by_attr) {
+        br_sem_take(&never, us);
+    } else {
+        br_sleep_us_slack(us, slack_us);
+    }
+    wake[idx] = br_uptime_us();
+
+    br_time_t slept = wake[idx] - start;
+    if (slept < us || slept > us + slack_us + LATENESS_US) {
+        outside++;
+    }
+
+    br_sem_give(&done);
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+/* Run one round of sleepers; returns the spread of their wake times */
+static br_time_t run_round(br_time_t slack, bool attr_slack)
+{
+    slack_us = slack;
+    by_attr  = attr_slack;
+    outside  = 0;
+
+    for (uint32_t i = 0; i < SLEEPERS; i++) {
+        br_task_attr_t attr;
+        br_task_attr_init(&attr);
+        attr.name        = "sleeper";
+        attr.priority    = 2;
+        attr.timer_slack = attr_slack ? slack : 0;
+
+        br_task_create_attr(&sleeper_tid[i], &attr, sleeper_task,
+                            (void *)(uintptr_t)i,
+                            stack_sleeper[i], sizeof(stack_sleeper[i]));
+    }
+    for (uint32_t i = 0; i < SLEEPERS; i++) {
+        br_sem_take(&done, BR_TIME_INFINITE);
+    }
+
+    br_time_t first = wake[0];
+    br_time_t last  = wake[0];
+    for (uint32_t i = 1; i < SLEEPERS; i++) {
+        if (wake[i] < first) {
+            first = wake[i];
+        }
+        if (wake[i] > last) {
+            last = wake[i];
+        }
+    }
+    return last - first;
+}
+
+/* Sleepers of the previous round are parked; free their stacks */
+static void reap(void)
+{
+    for (uint32_t i = 0; i < SLEEPERS; i++) {
+        br_task_delete(sleeper_tid[i]);
+    }
+}
+
+static void supervisor_task(void *arg)
+{
+    (void)arg;
+
+    br_uart_puts("\n=== Timer Slack Test ===\n\n");
+
+    br_time_t spread = run_round(BR_MSEC(SLACK_MS), false);
+    br_uart_puts("Test 1: sleeps with slack ");
+    if (spread < TOGETHER_US && outside == 0) {
+        br_uart_puts("woke together - PASS\n");
+    } else {
+        br_uart_puts(outside ? "woke outside their window - FAIL\n"
+                             : "woke apart - FAIL\n");
+    }
+
+    reap();
+    spread = run_round(0, false);
+    br_uart_puts("Test 2: sleeps without slack ");
+    if (spread >= BR_MSEC((SLEEPERS - 1U) * STEP_MS) - TOGETHER_US &&
+        outside == 0) {
+        br_uart_puts("woke one by one - PASS\n");
+    } else {
+        br_uart_puts(outside ? "woke late - FAIL\n" : "woke together - FAIL\n");
+    }
+
+    reap();
+    spread = run_round(BR_MSEC(SLACK_MS), true);
+    br_uart_puts("Test 3: timed waits with task slack ");
+    if (spread < TOGETHER_US && outside == 0) {
+        br_uart_puts("woke together - PASS\n");
+    } else {
+        br_uart_puts(outside ? "woke outside their window - FAIL\n"
+                             : "woke apart - FAIL\n");
+    }
+
+    br_uart_puts("\n=== Timer Slack Test Complete ===\n");
+
+    br_sem_take(&park, BR_TIME_INFINITE);
+}
+
+int main(void)
+{
+    br_kernel_init();
+
+    br_sem_init(&done, 0, SLEEPERS);
+    br_sem_init(&never, 0, 1);
+    br_sem_init(&park, 0, 1);
+
+    br_task_create(NULL, "supervisor", supervisor_task, NULL,
+                   1, stack_supervisor, sizeof(stack_supervisor));
+
+    br_kernel_start();
+}
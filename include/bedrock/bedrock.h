@@ -76,11 +76,107 @@ BR_STABLE br_err_t br_task_create(br_tid_t *tid,
                                    void *stack,
                                    size_t stack_size);
 
+/*
+ * br_task_create_attr — create a task from an attribute block.
+ *
+ * EXPERIMENTAL: the attribute struct grows with new scheduling options.
+ * Always fill it with br_task_attr_init() first.  BR_SCHED_EDF requires
+ * CONFIG_SCHED_EDF; the task then runs in the EDF band, ordered by
+ * absolute deadline, and its first job is released at creation.
+ * BR_POLICY_FIFO exempts the task from time slicing among tasks of its
+ * priority; BR_POLICY_RR tasks may set their own slice length.
+ */
+BR_EXPERIMENTAL br_err_t br_task_create_attr(br_tid_t *tid,
+                                             const br_task_attr_t *attr,
+                                             br_task_entry_t entry,
+                                             void *arg,
+                                             void *stack,
+                                             size_t stack_size);
+
+static inline void br_task_attr_init(br_task_attr_t *attr)
+{
+    attr->name        = NULL;
+    attr->priority    = 0;
+    attr->sched_class = BR_SCHED_PRIO;
+    attr->policy      = BR_POLICY_RR;
+    attr->time_slice  = 0;
+    attr->deadline    = 0;
+    attr->period      = 0;
+    attr->budget      = NULL;
+    attr->timer_slack = 0;
+}
+
+/*
+ * br_budget_init — set up a CPU budget for br_task_attr_t.budget.
+ *
+ * EXPERIMENTAL.  Requires CONFIG_SCHED_BUDGET.  Tasks sharing the budget
+ * may together use `budget` microseconds of CPU time per `period`; once
+ * it is used up they are throttled until a new period starts.  A period
+ * starts when a task first runs on a full budget (sporadic server).
+ */
+BR_EXPERIMENTAL br_err_t br_budget_init(br_budget_t *b, br_time_t budget,
+                                        br_time_t period);
+
+/*
+ * br_task_wait_next_period — end the current job of a periodic EDF task.
+ *
+ * EXPERIMENTAL.  Sleeps until the next release (previous release +
+ * period) and moves the deadline one period on.  Returns BR_ERR_TIMEOUT
+ * without sleeping if that release has already passed (overrun), and
+ * BR_ERR_INVALID for tasks that are not periodic EDF tasks.
+ */
+BR_EXPERIMENTAL br_err_t br_task_wait_next_period(void);
+
+/*
+ * br_task_get_stats — read a task's CPU statistics.
+ *
+ * EXPERIMENTAL.  Requires CONFIG_TASK_STATS (BR_ERR_INVALID otherwise).
+ * The runtime of a task that is running right now includes its current
+ * stretch on the CPU.
+ */
+BR_EXPERIMENTAL br_err_t br_task_get_stats(br_tid_t tid,
+                                           br_task_stats_t *stats);
+
 BR_STABLE br_err_t br_task_suspend(br_tid_t tid);
 BR_STABLE br_err_t br_task_resume(br_tid_t tid);
 BR_STABLE void     br_task_yield(void);
 BR_STABLE br_tid_t br_task_self(void);
 
+/*
+ * br_cpu_id — index of the CPU the caller is running on.
+ *
+ * EXPERIMENTAL: always 0 unless built with CONFIG_SMP.  Without CPU
+ * affinity a task may migrate at any reschedule, so the value is only
+ * a hint.
+ */
+BR_EXPERIMENTAL uint32_t br_cpu_id(void);
+
+/*
+ * br_set_idle_hook — run background work in the idle task.
+ *
+ * EXPERIMENTAL.  Each CPU's idle task calls `hook` whenever it gets the
+ * CPU, before putting the CPU to sleep until the next interrupt.  While
+ * the hook returns true it is called again at once; return false once
+ * there is nothing left to do.  The hook runs at the lowest priority and
+ * must not block.  NULL removes it.
+ */
+BR_EXPERIMENTAL void br_set_idle_hook(br_idle_hook_t hook);
+
+/*
+ * br_power_state_count / br_power_get_stats — idle power-state use.
+ *
+ * EXPERIMENTAL.  With CONFIG_PM the idle task sleeps the CPU in the
+ * deepest state of the HAL's table whose entry and exit latencies fit
+ * before the next timer event, waking early by the exit latency so the
+ * event is still served on time.  br_power_get_stats() reports a state's
+ * latencies, how often it was chosen and the time spent in it.  Without
+ * CONFIG_PM there are no states: the count is 0 and BR_ERR_INVALID is
+ * returned.
+ */
+BR_EXPERIMENTAL uint32_t br_power_state_count(void);
+BR_EXPERIMENTAL br_err_t br_power_get_stats(uint32_t state,
+                                            br_power_stats_t *stats);
+
 /*
  * br_task_delete — return a task's slot to the pool.
  *
@@ -99,6 +195,103 @@ BR_STABLE br_time_t br_uptime_us(void);
 static inline void br_sleep_ms(uint32_t ms) { br_sleep_us(BR_MSEC(ms)); }
 static inline void br_sleep_s(uint32_t s)   { br_sleep_us(BR_SEC(s));   }
 
+/*
+ * br_sleep_until — sleep until the absolute time `abs_us` (br_uptime_us()).
+ *
+ * EXPERIMENTAL.  Yields instead if that time has already come.  Like
+ * br_sleep_us(), may end up to the task's timer slack late.
+ */
+BR_EXPERIMENTAL void br_sleep_until(br_time_t abs_us);
+
+/*
+ * br_periodic_init / br_periodic_wait — drift-free periodic loops.
+ *
+ * EXPERIMENTAL.  br_periodic_init() starts a schedule of releases every
+ * `period` microseconds from now.  br_periodic_wait() sleeps until the
+ * next release and records how late the task woke in the jitter
+ * statistics of `p`.  If the next release has already passed (overrun),
+ * it counts the overrun, moves the schedule to the latest release that
+ * has passed and returns BR_ERR_TIMEOUT at once.  Releases stay on the
+ * original time grid either way.  Only the task that waits on `p` may
+ * read its statistics while it is in use.
+ */
+BR_EXPERIMENTAL br_err_t br_periodic_init(br_periodic_t *p, br_time_t period);
+BR_EXPERIMENTAL br_err_t br_periodic_wait(br_periodic_t *p);
+
+/*
+ * br_sleep_us_slack — sleep at least `us` and at most `us + slack`.
+ *
+ * EXPERIMENTAL.  The kernel may end the sleep anywhere in that window so
+ * that it shares an alarm interrupt with other timeouts due in it.
+ * br_sleep_us() and the timed waits use the task's
+ * br_task_attr_t.timer_slack (0 unless set) the same way.
+ */
+BR_EXPERIMENTAL void br_sleep_us_slack(br_time_t us, br_time_t slack);
+
+/*
+ * br_cycles_now — read the free-running cycle counter.
+ *
+ * EXPERIMENTAL.  Counts at BR_HAL_SYS_CLOCK_HZ, the timer tick rate, and
+ * wraps every 2^32 cycles; the unsigned difference of two readings times
+ * a region shorter than that.  A single register read on Cortex-M, so
+ * cheap enough for ISR and driver paths, and callable from any context.
+ */
+static inline br_cycles_t br_cycles_now(void) { return br_hal_cycles_now(); }
+
+static inline uint64_t br_cycles_to_ns(br_cycles_t cycles)
+{
+    return (uint64_t)cycles * 1000U / BR_HAL_TICKS_PER_US;
+}
+
+/*
+ * Code-region probes (CONFIG_PROBES).
+ *
+ * EXPERIMENTAL.  BR_PROBE_BEGIN(id) and BR_PROBE_END(id), in the same
+ * block, time the code between them and add the cycles to probe `id`
+ * (0 to CONFIG_PROBE_COUNT - 1): count, min, max, total for the mean and
+ * a log2 histogram.  `id` must be a single name or number, because it
+ * also names the local variable BR_PROBE_BEGIN() declares for the start
+ * time.  The start lives on the stack, so one probe may be used by tasks
+ * and ISRs at once.  Without CONFIG_PROBES both macros compile to
+ * nothing.  br_probe_record() adds a length measured some other way,
+ * br_probe_read() copies out a probe's statistics and br_probe_reset()
+ * clears them; both return BR_ERR_INVALID without CONFIG_PROBES.
+ */
+#if CONFIG_PROBES
+#define BR_PROBE_BEGIN(id) \
+    br_cycles_t br_probe_start_##id = br_cycles_now()
+#define BR_PROBE_END(id) \
+    br_probe_record((id), br_cycles_now() - br_probe_start_##id)
+#else
+#define BR_PROBE_BEGIN(id)  do { } while (0)
+#define BR_PROBE_END(id)    do { } while (0)
+#endif
+
+BR_EXPERIMENTAL void     br_probe_record(uint32_t id, br_cycles_t cycles);
+BR_EXPERIMENTAL br_err_t br_probe_read(uint32_t id, br_probe_t *out);
+BR_EXPERIMENTAL br_err_t br_probe_reset(uint32_t id);
+
+/*
+ * Software timers (CONFIG_TIMERS).
+ *
+ * EXPERIMENTAL.  br_timer_init() binds a callback; BR_TIMER_ISR in
+ * `flags` has it called from the alarm interrupt with interrupts
+ * disabled (keep it short and non-blocking), otherwise it runs in the
+ * timer service task at CONFIG_TIMER_SERVICE_PRIO, where it may block.
+ * br_timer_start() (re)starts the timer to expire after `delay`
+ * microseconds and then, if `period` is non-zero, every `period`
+ * microseconds; periods missed entirely are skipped.  br_timer_stop()
+ * cancels the timer, including a service-task callback not yet run.
+ * Both may be called from ISRs and from timer callbacks; a running
+ * timer must be stopped before it is initialized again.
+ */
+BR_EXPERIMENTAL br_err_t br_timer_init(br_timer_t *timer,
+                                       br_timer_fn_t callback, void *arg,
+                                       uint8_t flags);
+BR_EXPERIMENTAL br_err_t br_timer_start(br_timer_t *timer, br_time_t delay,
+                                        br_time_t period);
+BR_EXPERIMENTAL br_err_t br_timer_stop(br_timer_t *timer);
+
 /*
  * br_time_alarm_handler — invoked by the HAL timer ISR on alarm expiry.
  *
@@ -120,6 +313,17 @@ BR_STABLE br_err_t br_mutex_init(br_mutex_t *mtx);
 BR_STABLE br_err_t br_mutex_lock(br_mutex_t *mtx, br_time_t timeout);
 BR_STABLE br_err_t br_mutex_unlock(br_mutex_t *mtx);
 
+/*
+ * br_mutex_init_ceiling — initialize a mutex with a priority ceiling.
+ *
+ * EXPERIMENTAL.  Immediate priority-ceiling protocol: the locking task
+ * runs at `ceiling` (or its own priority, if higher) until it unlocks.
+ * `ceiling` must be at least the highest priority of any task that
+ * locks the mutex.
+ */
+BR_EXPERIMENTAL br_err_t br_mutex_init_ceiling(br_mutex_t *mtx,
+                                               uint8_t ceiling);
+
 /* Message queue */
 
 BR_STABLE br_err_t br_mqueue_init(br_mqueue_t *mq, void *buffer,
@@ -129,6 +333,49 @@ BR_STABLE br_err_t br_mqueue_send(br_mqueue_t *mq, const void *msg,
 BR_STABLE br_err_t br_mqueue_recv(br_mqueue_t *mq, void *msg,
                                    br_time_t timeout);
 
+/*
+ * Zero-copy message queue access.
+ *
+ * EXPERIMENTAL.  br_mqueue_reserve() hands out the next free slot of the
+ * queue in `*slot` for the caller to fill in place; br_mqueue_commit()
+ * queues it as a message.  br_mqueue_peek() hands out the oldest message
+ * in `*msg` for the caller to read in place; br_mqueue_release() removes
+ * it and frees its slot.  Both block and time out like br_mqueue_send()
+ * and br_mqueue_recv(), and mix freely with them.  A queue has at most
+ * one reserved slot and one peeked message at a time: while they are
+ * held, other producers see the queue as full and other consumers see
+ * it as empty, so hold them only as long as it takes to fill or process
+ * one message.  Commit and release return BR_ERR_INVALID if nothing is
+ * held, and may be called from ISRs.
+ */
+BR_EXPERIMENTAL br_err_t br_mqueue_reserve(br_mqueue_t *mq, void **slot,
+                                           br_time_t timeout);
+BR_EXPERIMENTAL br_err_t br_mqueue_commit(br_mqueue_t *mq);
+BR_EXPERIMENTAL br_err_t br_mqueue_peek(br_mqueue_t *mq, void **msg,
+                                        br_time_t timeout);
+BR_EXPERIMENTAL br_err_t br_mqueue_release(br_mqueue_t *mq);
+
+/*
+ * br_mqueue_send_n / br_mqueue_recv_n — move up to `n` messages at once.
+ *
+ * EXPERIMENTAL.  `msgs` is an array of `n` messages of the queue's
+ * message size.  Moves as many as the queue takes (or holds) in one
+ * critical section, waking every task that enables and rescheduling at
+ * most once, then, while fewer than `min` have moved, blocks for the
+ * next one like br_mqueue_send() / br_mqueue_recv().  `min` 0 returns
+ * at once with what was available.  Returns BR_OK once at least `min`
+ * have moved, or BR_ERR_TIMEOUT (BR_ERR_ISR in an ISR) if not; either
+ * way `*sent` / `*received`, if not NULL, tells how many moved, in
+ * order, and none of them is lost.
+ */
+BR_EXPERIMENTAL br_err_t br_mqueue_send_n(br_mqueue_t *mq, const void *msgs,
+                                          size_t n, size_t min, size_t *sent,
+                                          br_time_t timeout);
+BR_EXPERIMENTAL br_err_t br_mqueue_recv_n(br_mqueue_t *mq, void *msgs,
+                                          size_t n, size_t min,
+                                          size_t *received,
+                                          br_time_t timeout);
+
 /* Panic and assertions — see br_assert.h for BR_PANIC() and br_assert() */
 
 BR_STABLE void br_set_panic_handler(br_panic_handler_t handler);
@@ -52,6 +52,67 @@
 #  define CONFIG_ASSERT             1
 #endif
 
+#ifndef CONFIG_SCHED_EDF
+#  define CONFIG_SCHED_EDF          0
+#endif
+
+#ifndef CONFIG_SCHED_EDF_PRIO
+#  define CONFIG_SCHED_EDF_PRIO     0
+#endif
+
+#ifndef CONFIG_SCHED_BUDGET
+#  define CONFIG_SCHED_BUDGET       0
+#endif
+
+#ifndef CONFIG_TASK_STATS
+#  define CONFIG_TASK_STATS         0
+#endif
+
+#ifndef CONFIG_TIMERS
+#  define CONFIG_TIMERS             0
+#endif
+
+#ifndef CONFIG_TIMER_SERVICE_PRIO
+#  define CONFIG_TIMER_SERVICE_PRIO 1
+#endif
+
+#ifndef CONFIG_TIMER_SERVICE_STACK_SIZE
+#  define CONFIG_TIMER_SERVICE_STACK_SIZE 1024
+#endif
+
+#ifndef CONFIG_PROBES
+#  define CONFIG_PROBES             0
+#endif
+
+#ifndef CONFIG_PROBE_COUNT
+#  define CONFIG_PROBE_COUNT        16
+#endif
+
+#ifndef CONFIG_PM
+#  define CONFIG_PM                 0
+#endif
+
+#ifndef CONFIG_SMP
+#  define CONFIG_SMP                0
+#endif
+
+#ifndef CONFIG_ARM_BASEPRI
+#  define CONFIG_ARM_BASEPRI        0
+#endif
+
+#ifndef CONFIG_ARM_BASEPRI_THRESHOLD
+#  define CONFIG_ARM_BASEPRI_THRESHOLD 64
+#endif
+
+#if CONFIG_SMP
+#  ifndef CONFIG_NUM_CPUS
+#    define CONFIG_NUM_CPUS         4
+#  endif
+#else
+#  undef  CONFIG_NUM_CPUS
+#  define CONFIG_NUM_CPUS           1
+#endif
+
 /* Map Kconfig SYS_CLOCK_HZ to the name used by the HAL timer implementation */
 #ifndef BR_HAL_SYS_CLOCK_HZ
 #  ifdef CONFIG_SYS_CLOCK_HZ
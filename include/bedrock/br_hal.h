@@ -26,26 +26,150 @@
  * directly -- only through this interface.
  */
 
-/* Timer HAL -- tickless time source */
+/*
+ * Timer HAL -- tickless time source
+ *
+ * Time is a free-running 64-bit count of ticks at BR_HAL_SYS_CLOCK_HZ,
+ * in whatever unit the hardware counts, so reading it needs no division.
+ */
 
 void br_hal_timer_init(void);
-br_time_t br_hal_timer_get_us(void);
-void br_hal_timer_set_alarm(br_time_t abs_us);
+br_tick_t br_hal_timer_get_ticks(void);
+void br_hal_timer_set_alarm(br_tick_t abs_ticks);
 void br_hal_timer_cancel_alarm(void);
 
+/* Free-running cycle counter at BR_HAL_SYS_CLOCK_HZ, read without
+ * locking; any context, wraps every 2^32 cycles */
+br_cycles_t br_hal_cycles_now(void);
+
+/* Conversion between ticks and the microseconds of the public API */
+
+#define BR_HAL_TICKS_PER_US  ((uint32_t)(BR_HAL_SYS_CLOCK_HZ / 1000000UL))
+
+#if BR_HAL_SYS_CLOCK_HZ < 1000000UL
+#error "BR_HAL_SYS_CLOCK_HZ must be >= 1MHz for microsecond timer resolution"
+#endif
+
+/* Saturates at BR_TICK_INFINITE */
+static inline br_tick_t br_us_to_ticks(br_time_t us)
+{
+    if (us >= BR_TICK_INFINITE / BR_HAL_TICKS_PER_US) {
+        return BR_TICK_INFINITE;
+    }
+    return us * BR_HAL_TICKS_PER_US;
+}
+
+/*
+ * ticks / BR_HAL_TICKS_PER_US without a 64-bit division (a library call
+ * on 32-bit cores): multiply by the 0.32 fixed-point reciprocal, which
+ * never overshoots, and repeat on the remainder until it is below one
+ * microsecond.  Each round shrinks the remainder by about 2^32 / the
+ * rounding error, so two or three rounds cover the whole range.  A
+ * power-of-two rate compiles to a shift instead.
+ */
+static inline br_time_t br_ticks_to_us(br_tick_t ticks)
+{
+    const uint32_t tpu = BR_HAL_TICKS_PER_US;
+
+    if ((tpu & (tpu - 1U)) == 0U) {
+        return ticks / tpu;
+    }
+
+    const uint32_t recip = (uint32_t)(0xFFFFFFFFUL / tpu);
+    br_time_t us = 0;
+    br_tick_t rem = ticks;
+
+    while (rem >= tpu) {
+        br_time_t q = (rem >> 32) * recip +
+                      (((uint64_t)(uint32_t)rem * recip) >> 32);
+        if (q == 0) {
+            q = 1;
+        }
+        us  += q;
+        rem -= q * tpu;
+    }
+    return us;
+}
+
 /* Interrupt control HAL */
 
 uint32_t br_hal_irq_disable(void);
 void br_hal_irq_restore(uint32_t state);
 bool br_hal_in_isr(void);
 
+/*
+ * Put the calling CPU to sleep until an interrupt has been taken.  Called
+ * by the idle task with interrupts enabled; returning early is harmless,
+ * it is called again.
+ */
+void br_hal_cpu_idle(void);
+
+/*
+ * Power state HAL (CONFIG_PM)
+ *
+ * br_hal_power_states() returns the CPU's low-power states, shallowest
+ * first; state 0 must cost no latency.  br_hal_power_enter() sleeps in
+ * one until an interrupt is pending.  It is called with interrupts
+ * disabled and returns with them still disabled; the pending interrupt
+ * is taken once the kernel restores them.  br_hal_timer_get_ticks() must
+ * account for the time spent asleep, even in states that stop the
+ * timer.
+ */
+#define BR_HAL_POWER_STATES_MAX  8
+
+const br_power_state_t *br_hal_power_states(uint32_t *count);
+void br_hal_power_enter(uint32_t state);
+
 /* Context switch HAL */
 
 void *br_hal_stack_init(void *stack_top, br_task_entry_t entry, void *arg);
+/* Give back what br_hal_stack_init() set up, for a deleted task */
+void br_hal_stack_release(void *sp);
 void br_hal_context_switch(void **old_sp, void **new_sp);
 void br_hal_start_first_task(void *sp) __attribute__((noreturn));
 void br_hal_check_stack_overflow(br_tcb_t *tcb);
 
+/*
+ * Arrange for br_sched_isr_exit() to run once the current interrupt
+ * returns.  Called by the kernel whenever an ISR-context call makes a
+ * higher-priority task ready.
+ */
+void br_hal_pend_reschedule(void);
+
+#if CONFIG_SMP
+
+/*
+ * SMP HAL
+ *
+ * With CONFIG_SMP, br_hal_irq_disable()/br_hal_irq_restore() mask
+ * interrupts on the calling CPU *and* take a recursive kernel-wide lock,
+ * so existing kernel critical sections stay correct across CPUs.  The
+ * scheduler's per-CPU run queues use the finer-grained primitives below.
+ */
+
+/* Index of the calling CPU, 0 .. CONFIG_NUM_CPUS - 1 */
+uint32_t br_hal_cpu_id(void);
+
+/*
+ * Bring up CPUs 1 .. CONFIG_NUM_CPUS - 1; each calls entry() with its
+ * interrupts masked.  Called by the boot CPU just before it starts its
+ * own first task.
+ */
+void br_hal_smp_start(void (*entry)(void));
+
+/* Inter-processor interrupt: make cpu run br_sched_isr_exit() */
+void br_hal_ipi_send(uint32_t cpu);
+
+/* Mask / unmask interrupts on the calling CPU only */
+uint32_t br_hal_irq_local_disable(void);
+void br_hal_irq_local_restore(uint32_t state);
+
+void br_hal_spin_lock(br_spinlock_t *lock);
+bool br_hal_spin_trylock(br_spinlock_t *lock);
+void br_hal_spin_unlock(br_spinlock_t *lock);
+
+#endif /* CONFIG_SMP */
+
 /* Board / early init HAL */
 
 void br_hal_board_init(void);
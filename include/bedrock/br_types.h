@@ -30,9 +30,21 @@ typedef uint64_t br_time_t;
 #define BR_MSEC(ms)       ((br_time_t)(ms) * 1000U)
 #define BR_SEC(s)         ((br_time_t)(s)  * 1000000U)
 
+/*
+ * Kernel-internal time -- 64-bit count of HAL timer ticks
+ * (BR_HAL_SYS_CLOCK_HZ).  The kernel keeps every deadline in ticks and
+ * converts from and to br_time_t only where the public API needs it.
+ */
+typedef uint64_t br_tick_t;
+
+#define BR_TICK_INFINITE  UINT64_MAX
+
 /* Stack overflow detection canary value */
 #define BR_STACK_CANARY   0xDEADBEEF
 
+/* br_mutex_t.ceiling of a mutex without a priority ceiling */
+#define BR_MUTEX_NO_CEILING  0xFFU
+
 /* Error codes */
 typedef enum {
     BR_OK            =  0,
@@ -55,9 +67,144 @@ typedef enum {
 } br_task_state_t;
 
 /* Task ID & entry point */
-typedef uint8_t  br_tid_t;
+typedef uint32_t br_tid_t;
 typedef void (*br_task_entry_t)(void *arg);
 
+/* Idle hook, see br_set_idle_hook(); returns true while it has more work */
+typedef bool (*br_idle_hook_t)(void);
+
+/* Scheduling class */
+typedef enum {
+    BR_SCHED_PRIO = 0,    /* Fixed priority (default) */
+    BR_SCHED_EDF  = 1     /* Earliest deadline first (CONFIG_SCHED_EDF) */
+} br_sched_class_t;
+
+/* Policy among ready tasks of equal priority */
+typedef enum {
+    BR_POLICY_RR   = 0,   /* Time-sliced round robin (default) */
+    BR_POLICY_FIFO = 1    /* Runs until it blocks, yields or is preempted */
+} br_sched_policy_t;
+
+/*
+ * CPU budget (CONFIG_SCHED_BUDGET): at most `budget` microseconds of CPU
+ * time per replenishment period.  Point one task at it for a per-task
+ * reservation, or several tasks for a group reservation.  Set up with
+ * br_budget_init(); the fields are kept in timer ticks.
+ */
+typedef struct {
+    br_tick_t          budget;        /* CPU time per period */
+    br_tick_t          period;        /* Replenishment period */
+    br_tick_t          remaining;     /* Left in the current period */
+    br_tick_t          replenish;     /* When the current period ends */
+} br_budget_t;
+
+/* Per-task CPU statistics (CONFIG_TASK_STATS), see br_task_get_stats() */
+typedef struct {
+    br_time_t          runtime;       /* CPU time consumed (us) */
+    uint32_t           switches;      /* Times switched in */
+    uint32_t           preemptions;   /* Switched out while still runnable */
+    uint32_t           voluntary;     /* Switched out by blocking or yielding */
+} br_task_stats_t;
+
+/* Bins of br_periodic_t.jitter_hist: bin 0 counts releases with no
+ * jitter, bin i those with 2^(i-1) to 2^i - 1 us, the last bin all
+ * longer ones */
+#define BR_PERIODIC_HIST_BINS  16
+
+/* Periodic release schedule with jitter statistics, see br_periodic_init() */
+typedef struct {
+    br_time_t          period;        /* us */
+    br_time_t          release;       /* Current release time */
+    uint32_t           releases;      /* Waits that slept until a release */
+    uint32_t           overruns;      /* Waits that found it already past */
+    br_time_t          jitter_min;    /* Wakeup after release (us) */
+    br_time_t          jitter_max;
+    uint32_t           jitter_hist[BR_PERIODIC_HIST_BINS];
+} br_periodic_t;
+
+/* CPU low-power state (CONFIG_PM), an entry of br_hal_power_states() */
+typedef struct {
+    const char        *name;
+    br_time_t          entry_latency; /* us from starting to enter it */
+    br_time_t          exit_latency;  /* us from the wakeup interrupt
+                                         until the CPU runs again */
+} br_power_state_t;
+
+/* Use of one power state, see br_power_get_stats() */
+typedef struct {
+    const char        *name;
+    br_time_t          entry_latency; /* us */
+    br_time_t          exit_latency;  /* us */
+    uint32_t           entries;       /* Times the idle governor chose it */
+    br_time_t          residency;     /* us spent in it, latencies included */
+} br_power_stats_t;
+
+/* Cycle counter reading, see br_cycles_now().  The counter wraps, so
+ * only the difference of two readings means anything. */
+typedef uint32_t br_cycles_t;
+
+/* Bins of br_probe_t.hist: bin 0 counts regions that took no cycles,
+ * bin i those of 2^(i-1) to 2^i - 1 cycles, the last bin all longer ones */
+#define BR_PROBE_HIST_BINS     24
+
+/* Statistics of one code-region probe (CONFIG_PROBES), see BR_PROBE_BEGIN() */
+typedef struct {
+    uint32_t           count;         /* Regions recorded */
+    br_cycles_t        min;           /* Cycles */
+    br_cycles_t        max;
+    uint64_t           total;         /* Sum of all, for the mean */
+    uint32_t           hist[BR_PROBE_HIST_BINS];
+} br_probe_t;
+
+/*
+ * Task creation attributes for br_task_create_attr().  Start from
+ * br_task_attr_init() so that fields added later keep their defaults.
+ */
+typedef struct {
+    const char        *name;
+    uint8_t            priority;      /* BR_SCHED_PRIO: 0 = highest */
+    br_sched_class_t   sched_class;
+    br_sched_policy_t  policy;
+    uint32_t           time_slice;    /* BR_POLICY_RR: slice (us), 0 = default */
+    br_time_t          deadline;      /* BR_SCHED_EDF: relative deadline (us) */
+    br_time_t          period;        /* BR_SCHED_EDF: release period (us) */
+    br_budget_t       *budget;        /* CPU reservation, NULL = unlimited */
+    br_time_t          timer_slack;   /* Sleeps / timed waits may end this
+                                         much late (us), to share wakeups */
+} br_task_attr_t;
+
+struct br_mutex;
+
+/* Entry of the kernel's timeout heap (a pairing heap ordered by deadline) */
+typedef struct br_timeout {
+    br_tick_t           deadline;      /* Latest expiry, the heap key */
+    br_tick_t           earliest;      /* Earliest expiry, deadline - slack */
+    struct br_timeout  *child;         /* First child */
+    struct br_timeout  *sibling;       /* Next sibling */
+    struct br_timeout  *prev;          /* Previous sibling, or the parent
+                                          of a first child; NULL at the root
+                                          and when not queued */
+    void              (*expire)(struct br_timeout *t); /* Run by the alarm
+                                          handler, IRQs disabled */
+} br_timeout_t;
+
+/* Software timer (CONFIG_TIMERS), see br_timer_init() */
+typedef struct br_timer br_timer_t;
+typedef void (*br_timer_fn_t)(br_timer_t *timer, void *arg);
+
+/* br_timer_init() flags */
+#define BR_TIMER_ISR        0x01U     /* Call back from the alarm interrupt */
+
+struct br_timer {
+    br_timeout_t        timeout;       /* Entry in the kernel's timeout heap */
+    br_timer_fn_t       callback;
+    void               *arg;
+    br_tick_t           period;        /* 0 = one-shot */
+    uint8_t             flags;         /* BR_TIMER_* */
+    bool                pending;       /* Queued for the timer service task */
+    struct br_timer    *next_pending;
+};
+
 /* Task Control Block (TCB) */
 typedef struct br_tcb {
     /* Saved stack pointer -- must be first for context switch asm */
@@ -65,7 +212,8 @@ typedef struct br_tcb {
 
     br_tid_t            id;
     br_task_state_t     state;
-    uint8_t             priority;      /* 0 = highest */
+    uint8_t             priority;      /* Effective priority, 0 = highest */
+    uint8_t             base_priority; /* Priority without inheritance */
     const char         *name;
 
     /* Stack region */
@@ -78,14 +226,52 @@ typedef struct br_tcb {
     void               *arg;
 
     /* Scheduler bookkeeping */
-    br_time_t           wake_time;     /* Used by sleep / timed waits */
-    uint16_t            rr_remaining;  /* Round-robin time-slice ticks */
+    br_timeout_t        timeout;       /* Used by sleep / timed waits */
+    br_tick_t           timer_slack;   /* Lateness allowed for its timeouts */
+    br_tick_t           slice_end;     /* End of the time slice, 0 = used up */
+    br_tick_t           time_slice;    /* Round-robin slice length */
+    uint8_t             policy;        /* br_sched_policy_t */
     br_err_t            wait_result;   /* Result after waking from block */
 
+    struct br_tcb     **wait_queue;    /* Wait queue blocked on, or NULL */
+    void               *wait_buf;      /* Message of a blocked send / recv */
+
+    /* Priority inheritance */
+    struct br_mutex    *held_mutexes;  /* Mutexes owned, newest first */
+    struct br_mutex    *blocked_on;    /* Mutex being waited for */
+
+#if CONFIG_SCHED_EDF
+    br_sched_class_t    sched_class;
+    br_tick_t           rel_deadline;  /* Relative deadline */
+    br_tick_t           period;        /* Release period, 0 = aperiodic */
+    br_tick_t           release;       /* Start of the current job */
+    br_tick_t           abs_deadline;  /* EDF band sort key */
+#endif
+
+#if CONFIG_SCHED_BUDGET
+    br_budget_t        *budget;        /* NULL = unlimited */
+    br_tick_t           exec_start;    /* When the task was last charged */
+#endif
+
+#if CONFIG_TASK_STATS
+    br_task_stats_t     stats;         /* runtime kept in ticks */
+    br_tick_t           run_start;     /* When the task was last switched in */
+    bool                yielded;       /* Gave up the CPU in br_task_yield() */
+#endif
+
+#if CONFIG_SMP
+    uint8_t             cpu;           /* CPU whose run queue owns the task */
+#endif
+
     /* Simple linked-list pointers for ready / wait queues */
     struct br_tcb      *next;
 } br_tcb_t;
 
+/* Spinlock (SMP builds) -- only ever taken through the br_hal_spin_*() HAL */
+typedef struct {
+    volatile uint32_t locked;
+} br_spinlock_t;
+
 /* Semaphore */
 typedef struct {
     volatile int32_t  count;
@@ -93,12 +279,13 @@ typedef struct {
     br_tcb_t         *wait_queue;     /* Head of blocked tasks */
 } br_sem_t;
 
-/* Mutex (with priority inheritance support) */
-typedef struct {
+/* Mutex (with priority inheritance and optional priority ceiling) */
+typedef struct br_mutex {
     volatile bool      locked;
     br_tcb_t          *owner;
-    uint8_t            owner_orig_prio;  /* For priority inheritance */
-    br_tcb_t          *wait_queue;
+    struct br_mutex   *next_held;        /* Owner's list of held mutexes */
+    uint8_t            ceiling;          /* BR_MUTEX_NO_CEILING = none */
+    br_tcb_t          *wait_queue;       /* Sorted by priority */
 } br_mutex_t;
 
 /* Message Queue (fixed-size ring buffer, statically allocated) */
@@ -109,6 +296,8 @@ typedef struct {
     volatile size_t    count;         /* Current number of messages */
     size_t             head;
     size_t             tail;
+    bool               reserved;      /* Tail slot held by br_mqueue_reserve */
+    bool               peeked;        /* Head message held by br_mqueue_peek */
     br_tcb_t          *send_wait;     /* Tasks blocked on full queue */
     br_tcb_t          *recv_wait;     /* Tasks blocked on empty queue */
 } br_mqueue_t;
@@ -19,8 +19,11 @@
 extern void     br_sched_ready(br_tcb_t *tcb);
 extern void     br_sched_reschedule(void);
 extern br_tcb_t *br_sched_current(void);
-extern void     br_time_sleep_list_insert(br_tcb_t *tcb);
-extern void     br_time_sleep_list_remove(br_tcb_t *tcb);
+extern void     br_sched_set_priority(br_tcb_t *tcb, uint8_t prio);
+extern void     br_time_timeout_add(br_tcb_t *tcb, br_tick_t deadline,
+                                    br_tick_t slack);
+extern br_tick_t br_time_deadline(br_time_t us);
+extern void     br_time_timeout_remove(br_tcb_t *tcb);
 
 /* Wait queue helpers */
 
@@ -64,35 +67,49 @@ static void wq_remove(br_tcb_t **head, br_tcb_t *tcb)
 }
 
 /*
- * Block the current task on a wait queue with optional timeout.
- * If timeout == BR_TIME_INFINITE, wait forever.
- * Otherwise, also insert into the sleep list so the alarm handler
- * can wake us with BR_ERR_TIMEOUT.
+ * Block the current task on a wait queue until the tick `deadline`.
+ * If deadline == BR_TICK_INFINITE, wait forever.
+ * Otherwise, also add a timeout so the alarm handler can take us off
+ * the wait queue and wake us with BR_ERR_TIMEOUT.
  *
  * Must be called with IRQs disabled. Caller must call
  * br_hal_irq_restore + br_sched_reschedule after this returns.
  */
-static void block_on_wq(br_tcb_t **wq, br_tcb_t *tcb, br_time_t timeout)
+static void block_on_wq_until(br_tcb_t **wq, br_tcb_t *tcb,
+                              br_tick_t deadline)
 {
     tcb->state       = BR_TASK_BLOCKED;
     tcb->wait_result = BR_OK;
     wq_insert(wq, tcb);
+    tcb->wait_queue = wq;
 
-    if (timeout != BR_TIME_INFINITE) {
-        tcb->wake_time = br_hal_timer_get_us() + timeout;
-        br_time_sleep_list_insert(tcb);
+    if (deadline != BR_TICK_INFINITE) {
+        br_time_timeout_add(tcb, deadline, tcb->timer_slack);
     }
 }
 
+/* The deadline of a wait of `timeout` microseconds starting now */
+static br_tick_t wq_deadline(br_time_t timeout)
+{
+    return timeout == BR_TIME_INFINITE ? BR_TICK_INFINITE
+                                       : br_time_deadline(timeout);
+}
+
+/* Block with a timeout relative to now (BR_TIME_INFINITE = forever) */
+static void block_on_wq(br_tcb_t **wq, br_tcb_t *tcb, br_time_t timeout)
+{
+    block_on_wq_until(wq, tcb, wq_deadline(timeout));
+}
+
 /*
- * Wake a waiter from a wait queue (called by give/unlock/send/recv).
- * Removes from sleep list if it was there, sets wait_result = BR_OK.
+ * Wake a waiter popped from a wait queue (called by give/unlock/send/recv).
+ * Cancels its timeout if it had one, sets wait_result = BR_OK.
  */
 static void wake_waiter(br_tcb_t *tcb)
 {
     tcb->wait_result = BR_OK;
-    br_time_sleep_list_remove(tcb);
-    tcb->wake_time = 0;
+    tcb->wait_queue  = NULL;
+    br_time_timeout_remove(tcb);
     br_sched_ready(tcb);
 }
 
@@ -139,16 +156,8 @@ br_err_t br_sem_take(br_sem_t *sem, br_time_t timeout)
     br_hal_irq_restore(key);
     br_sched_reschedule();
 
-    /* Back from block: check why we woke up */
-    if (tcb->wait_result == BR_ERR_TIMEOUT) {
-        /* Woken by timer — remove ourselves from the wait queue */
-        uint32_t k2 = br_hal_irq_disable();
-        wq_remove(&sem->wait_queue, tcb);
-        br_hal_irq_restore(k2);
-        return BR_ERR_TIMEOUT;
-    }
-
-    return BR_OK;
+    /* On timeout br_ipc_abort_wait() has already dequeued us */
+    return tcb->wait_result;
 }
 
 br_err_t br_sem_give(br_sem_t *sem)
@@ -177,17 +186,94 @@ br_err_t br_sem_give(br_sem_t *sem)
     return BR_ERR_OVERFLOW;
 }
 
-/* Mutex (with priority inheritance) */
+/*
+ * Mutex (with priority inheritance)
+ *
+ * A mutex may also carry a priority ceiling.  The owner is raised to the
+ * ceiling as soon as it takes the lock, so no task that shares the mutex
+ * can preempt it and contend; inheritance then only covers misuse.  An
+ * ordinary mutex has BR_MUTEX_NO_CEILING, the lowest possible priority,
+ * so both kinds share one lock path.
+ *
+ * Every task keeps a list of the mutexes it holds and the mutex it is
+ * blocked on.  Its effective priority is derived from those: the highest
+ * of its base priority and, for each held mutex, the ceiling and the
+ * first (highest-priority) waiter.  Whenever a wait queue changes, the
+ * owner's priority is recomputed and the change is carried along the
+ * chain of owners blocked on further mutexes, so inheritance is
+ * transitive and unlocking one of several mutexes keeps the boosts that
+ * the others still justify.
+ */
+
+static uint8_t effective_priority(const br_tcb_t *tcb)
+{
+    uint8_t prio = tcb->base_priority;
+
+    for (const br_mutex_t *m = tcb->held_mutexes; m != NULL; m = m->next_held) {
+        if (m->ceiling < prio) {
+            prio = m->ceiling;
+        }
+        if (m->wait_queue != NULL && m->wait_queue->priority < prio) {
+            prio = m->wait_queue->priority;
+        }
+    }
+    return prio;
+}
+
+/*
+ * Bring a mutex owner's priority up to date and follow the blocking
+ * chain while priorities keep changing.  A task blocked on a mutex is
+ * moved to its new place in that mutex's wait queue.  A deadlock cycle
+ * ends the walk once every task in it has the same priority.
+ */
+static void prio_propagate(br_tcb_t *tcb)
+{
+    while (tcb != NULL) {
+        uint8_t prio = effective_priority(tcb);
+        if (prio == tcb->priority) {
+            return;
+        }
+        br_sched_set_priority(tcb, prio);
+
+        br_mutex_t *m = tcb->blocked_on;
+        if (m == NULL) {
+            return;
+        }
+        wq_remove(&m->wait_queue, tcb);
+        wq_insert(&m->wait_queue, tcb);
+        tcb = m->owner;
+    }
+}
+
+/* Record the current owner's hold on mtx */
+static void mutex_take(br_mutex_t *mtx, br_tcb_t *tcb)
+{
+    mtx->locked       = true;
+    mtx->owner        = tcb;
+    mtx->next_held    = tcb->held_mutexes;
+    tcb->held_mutexes = mtx;
+}
 
 br_err_t br_mutex_init(br_mutex_t *mtx)
+{
+    return br_mutex_init_ceiling(mtx, BR_MUTEX_NO_CEILING);
+}
+
+br_err_t br_mutex_init_ceiling(br_mutex_t *mtx, uint8_t ceiling)
 {
     if (mtx == NULL) {
         return BR_ERR_INVALID;
     }
-    mtx->locked          = false;
-    mtx->owner           = NULL;
-    mtx->owner_orig_prio = 0;
-    mtx->wait_queue      = NULL;
+#if CONFIG_NUM_PRIORITIES < 256
+    if (ceiling >= CONFIG_NUM_PRIORITIES && ceiling != BR_MUTEX_NO_CEILING) {
+        return BR_ERR_INVALID;
+    }
+#endif
+    mtx->locked     = false;
+    mtx->owner      = NULL;
+    mtx->next_held  = NULL;
+    mtx->ceiling    = ceiling;
+    mtx->wait_queue = NULL;
     return BR_OK;
 }
 
@@ -202,10 +288,14 @@ br_err_t br_mutex_lock(br_mutex_t *mtx, br_time_t timeout)
 
     uint32_t key = br_hal_irq_disable();
 
+    br_tcb_t *tcb = br_sched_current();
+
     if (!mtx->locked) {
-        mtx->locked          = true;
-        mtx->owner           = br_sched_current();
-        mtx->owner_orig_prio = mtx->owner->priority;
+        mutex_take(mtx, tcb);
+        /* Running, so not queued: the ceiling needs no requeue */
+        if (mtx->ceiling < tcb->priority) {
+            tcb->priority = mtx->ceiling;
+        }
         br_hal_irq_restore(key);
         return BR_OK;
     }
@@ -215,25 +305,33 @@ br_err_t br_mutex_lock(br_mutex_t *mtx, br_time_t timeout)
         return BR_ERR_TIMEOUT;
     }
 
-    br_tcb_t *tcb = br_sched_current();
-
-    if (tcb->priority < mtx->owner->priority) {
-        mtx->owner->priority = tcb->priority;
-    }
-
     block_on_wq(&mtx->wait_queue, tcb, timeout);
+    tcb->blocked_on = mtx;
+    prio_propagate(mtx->owner);
 
     br_hal_irq_restore(key);
     br_sched_reschedule();
 
-    if (tcb->wait_result == BR_ERR_TIMEOUT) {
-        uint32_t k2 = br_hal_irq_disable();
-        wq_remove(&mtx->wait_queue, tcb);
-        br_hal_irq_restore(k2);
-        return BR_ERR_TIMEOUT;
-    }
+    /* On timeout br_ipc_abort_wait() has already dequeued us */
+    return tcb->wait_result;
+}
 
-    return BR_OK;
+/*
+ * Called by the alarm handler and br_task_delete(), IRQs disabled, to
+ * withdraw a task from the wait queue it is blocked on.  A mutex owner
+ * loses at once whatever it inherited from the task.
+ */
+void br_ipc_abort_wait(br_tcb_t *tcb)
+{
+    br_mutex_t *mtx = tcb->blocked_on;
+
+    wq_remove(tcb->wait_queue, tcb);
+    tcb->wait_queue = NULL;
+
+    if (mtx != NULL) {
+        tcb->blocked_on = NULL;
+        prio_propagate(mtx->owner);
+    }
 }
 
 br_err_t br_mutex_unlock(br_mutex_t *mtx)
@@ -253,12 +351,25 @@ br_err_t br_mutex_unlock(br_mutex_t *mtx)
         return BR_ERR_INVALID;
     }
 
-    cur->priority = mtx->owner_orig_prio;
+    /* Usually the most recently locked one, at the head of the list */
+    br_mutex_t **pp = &cur->held_mutexes;
+    while (*pp != mtx) {
+        pp = &(*pp)->next_held;
+    }
+    *pp = mtx->next_held;
+    mtx->next_held = NULL;
+
+    /* Running, so not queued: no requeue needed */
+    uint8_t prio  = effective_priority(cur);
+    bool lowered  = prio > cur->priority;
+    cur->priority = prio;
 
     br_tcb_t *waiter = wq_pop(&mtx->wait_queue);
     if (waiter != NULL) {
-        mtx->owner           = waiter;
-        mtx->owner_orig_prio = waiter->priority;
+        /* Hand over; the new owner is blocked, so not queued either */
+        waiter->blocked_on = NULL;
+        mutex_take(mtx, waiter);
+        waiter->priority = effective_priority(waiter);
         wake_waiter(waiter);
         br_hal_irq_restore(key);
         br_sched_reschedule();
@@ -269,6 +380,11 @@ br_err_t br_mutex_unlock(br_mutex_t *mtx)
     mtx->owner  = NULL;
 
     br_hal_irq_restore(key);
+
+    /* Tasks readied while the owner ran raised may now preempt it */
+    if (lowered) {
+        br_sched_reschedule();
+    }
     return BR_OK;
 }
 
@@ -286,72 +402,171 @@ br_err_t br_mqueue_init(br_mqueue_t *mq, void *buffer,
     mq->count     = 0;
     mq->head      = 0;
     mq->tail      = 0;
+    mq->reserved  = false;
+    mq->peeked    = false;
     mq->send_wait = NULL;
     mq->recv_wait = NULL;
     return BR_OK;
 }
 
-br_err_t br_mqueue_send(br_mqueue_t *mq, const void *msg, br_time_t timeout)
+/*
+ * A message only ever moves once a receiver is ready for it: straight
+ * into a blocked receiver's buffer, or out of a blocked sender's buffer
+ * into the slot the receiver just freed, in the critical section that
+ * wakes the other task.  A task woken with BR_OK therefore has nothing
+ * left to do, and a blocking send cannot lose its message.
+ *
+ * The zero-copy calls work on the ring itself.  A reservation owns the
+ * slot at the tail and a peek the message at the head, so while one is
+ * held no other task may produce (resp. consume): the queue counts as
+ * full (resp. empty) for them.  Reservers and peekers wait on the same
+ * queues as senders and receivers, with wait_buf == NULL, and are
+ * granted the slot or message by whoever makes it available.
+ */
+
+static void mq_put(br_mqueue_t *mq, const void *msg)
 {
-    if (mq == NULL || msg == NULL) {
-        return BR_ERR_INVALID;
-    }
+    memcpy(mq->buffer + (mq->tail * mq->msg_size), msg, mq->msg_size);
+    mq->tail = (mq->tail + 1) % mq->max_msgs;
+    mq->count++;
+}
 
-    uint32_t key = br_hal_irq_disable();
+static void mq_get(br_mqueue_t *mq, void *msg)
+{
+    memcpy(msg, mq->buffer + (mq->head * mq->msg_size), mq->msg_size);
+    mq->head = (mq->head + 1) % mq->max_msgs;
+    mq->count--;
+}
+
+static bool mq_can_put(const br_mqueue_t *mq)
+{
+    return !mq->reserved && mq->count < mq->max_msgs;
+}
 
-    if (mq->count < mq->max_msgs) {
-        uint8_t *dst = mq->buffer + (mq->tail * mq->msg_size);
-        memcpy(dst, msg, mq->msg_size);
-        mq->tail = (mq->tail + 1) % mq->max_msgs;
-        mq->count++;
+static bool mq_can_get(const br_mqueue_t *mq)
+{
+    return !mq->peeked && mq->count > 0;
+}
 
-        /* Wake one receiver if any */
-        br_tcb_t *waiter = wq_pop(&mq->recv_wait);
-        if (waiter != NULL) {
-            wake_waiter(waiter);
-            br_hal_irq_restore(key);
-            br_sched_reschedule();
-            return BR_OK;
+/*
+ * Serve the tasks waiting on `mq` for as long as its state lets them
+ * proceed; returns true if any was woken.  Must be called with IRQs
+ * disabled after every change that can free a slot or publish a message.
+ */
+static bool mq_serve(br_mqueue_t *mq)
+{
+    bool woken = false;
+    bool progress;
+
+    do {
+        progress = false;
+
+        while (mq->recv_wait != NULL && mq_can_get(mq)) {
+            br_tcb_t *tcb = wq_pop(&mq->recv_wait);
+            if (tcb->wait_buf != NULL) {
+                mq_get(mq, tcb->wait_buf);
+            } else {
+                mq->peeked = true;
+            }
+            wake_waiter(tcb);
+            progress = true;
         }
 
-        br_hal_irq_restore(key);
-        return BR_OK;
-    }
+        while (mq->send_wait != NULL && mq_can_put(mq)) {
+            br_tcb_t *tcb = wq_pop(&mq->send_wait);
+            if (tcb->wait_buf != NULL) {
+                mq_put(mq, tcb->wait_buf);
+            } else {
+                mq->reserved = true;
+            }
+            wake_waiter(tcb);
+            progress = true;
+        }
 
-    if (timeout == 0) {
-        br_hal_irq_restore(key);
-        return BR_ERR_TIMEOUT;
-    }
+        woken |= progress;
+    } while (progress);
 
+    return woken;
+}
+
+/*
+ * Block the current task on one of the queue's wait queues until
+ * `deadline`, or fail at once in an ISR or if the deadline has passed.
+ * Called with IRQs disabled; restores `key` in every case.
+ */
+static br_err_t mq_block_until(br_tcb_t **wq, void *buf, br_tick_t deadline,
+                               uint32_t key)
+{
     if (br_hal_in_isr()) {
         br_hal_irq_restore(key);
         return BR_ERR_ISR;
     }
 
+    if (deadline != BR_TICK_INFINITE &&
+        br_hal_timer_get_ticks() >= deadline) {
+        br_hal_irq_restore(key);
+        return BR_ERR_TIMEOUT;
+    }
+
     br_tcb_t *tcb = br_sched_current();
-    block_on_wq(&mq->send_wait, tcb, timeout);
+    tcb->wait_buf = buf;
+    block_on_wq_until(wq, tcb, deadline);
 
     br_hal_irq_restore(key);
     br_sched_reschedule();
 
-    if (tcb->wait_result == BR_ERR_TIMEOUT) {
-        uint32_t k2 = br_hal_irq_disable();
-        wq_remove(&mq->send_wait, tcb);
-        br_hal_irq_restore(k2);
+    return tcb->wait_result;
+}
+
+/* As mq_block_until(), with a timeout; a zero timeout fails at once */
+static br_err_t mq_block(br_tcb_t **wq, void *buf, br_time_t timeout,
+                         uint32_t key)
+{
+    if (timeout == 0) {
+        br_hal_irq_restore(key);
         return BR_ERR_TIMEOUT;
     }
+    return mq_block_until(wq, buf, wq_deadline(timeout), key);
+}
 
-    /* Woken by recv — now enqueue the message */
-    key = br_hal_irq_disable();
-    if (mq->count < mq->max_msgs) {
-        uint8_t *dst = mq->buffer + (mq->tail * mq->msg_size);
-        memcpy(dst, msg, mq->msg_size);
-        mq->tail = (mq->tail + 1) % mq->max_msgs;
-        mq->count++;
-    }
+/* Serve the waiters after a change, then leave the critical section */
+static void mq_leave(br_mqueue_t *mq, uint32_t key)
+{
+    bool woken = mq_serve(mq);
     br_hal_irq_restore(key);
+    if (woken) {
+        br_sched_reschedule();
+    }
+}
 
-    return BR_OK;
+br_err_t br_mqueue_send(br_mqueue_t *mq, const void *msg, br_time_t timeout)
+{
+    if (mq == NULL || msg == NULL) {
+        return BR_ERR_INVALID;
+    }
+
+    uint32_t key = br_hal_irq_disable();
+
+    /* Receivers wait on an empty queue unless a peek holds the head:
+     * hand the message over */
+    if (mq->count == 0 && mq->recv_wait != NULL &&
+        mq->recv_wait->wait_buf != NULL) {
+        br_tcb_t *waiter = wq_pop(&mq->recv_wait);
+        memcpy(waiter->wait_buf, msg, mq->msg_size);
+        wake_waiter(waiter);
+        br_hal_irq_restore(key);
+        br_sched_reschedule();
+        return BR_OK;
+    }
+
+    if (mq_can_put(mq)) {
+        mq_put(mq, msg);
+        mq_leave(mq, key);             /* May grant a waiting peek */
+        return BR_OK;
+    }
+
+    /* BR_OK: a receiver has already queued the message */
+    return mq_block(&mq->send_wait, (void *)msg, timeout, key);
 }
 
 br_err_t br_mqueue_recv(br_mqueue_t *mq, void *msg, br_time_t timeout)
@@ -362,57 +577,224 @@ br_err_t br_mqueue_recv(br_mqueue_t *mq, void *msg, br_time_t timeout)
 
     uint32_t key = br_hal_irq_disable();
 
-    if (mq->count > 0) {
-        uint8_t *src = mq->buffer + (mq->head * mq->msg_size);
-        memcpy(msg, src, mq->msg_size);
-        mq->head = (mq->head + 1) % mq->max_msgs;
-        mq->count--;
-
-        /* Wake one sender if any */
-        br_tcb_t *sender = wq_pop(&mq->send_wait);
-        if (sender != NULL) {
-            wake_waiter(sender);
-            br_hal_irq_restore(key);
-            br_sched_reschedule();
-            return BR_OK;
-        }
+    if (mq_can_get(mq)) {
+        mq_get(mq, msg);
 
-        br_hal_irq_restore(key);
+        /* Senders wait on a full queue: queue the first one's message
+         * in the slot just freed, behind all the others, or grant it
+         * to a waiting reservation */
+        mq_leave(mq, key);
         return BR_OK;
     }
 
-    if (timeout == 0) {
+    /* BR_OK: a sender has already copied the message into msg */
+    return mq_block(&mq->recv_wait, msg, timeout, key);
+}
+
+br_err_t br_mqueue_reserve(br_mqueue_t *mq, void **slot, br_time_t timeout)
+{
+    if (mq == NULL || slot == NULL) {
+        return BR_ERR_INVALID;
+    }
+
+    uint32_t key = br_hal_irq_disable();
+
+    if (mq_can_put(mq)) {
+        mq->reserved = true;
         br_hal_irq_restore(key);
-        return BR_ERR_TIMEOUT;
+    } else {
+        /* BR_OK: the reservation was granted to us */
+        br_err_t err = mq_block(&mq->send_wait, NULL, timeout, key);
+        if (err != BR_OK) {
+            return err;
+        }
     }
 
-    if (br_hal_in_isr()) {
+    /* The tail cannot move while we hold the reservation */
+    *slot = mq->buffer + (mq->tail * mq->msg_size);
+    return BR_OK;
+}
+
+br_err_t br_mqueue_commit(br_mqueue_t *mq)
+{
+    if (mq == NULL) {
+        return BR_ERR_INVALID;
+    }
+
+    uint32_t key = br_hal_irq_disable();
+
+    if (!mq->reserved) {
         br_hal_irq_restore(key);
-        return BR_ERR_ISR;
+        return BR_ERR_INVALID;
     }
 
-    br_tcb_t *tcb = br_sched_current();
-    block_on_wq(&mq->recv_wait, tcb, timeout);
+    mq->reserved = false;
+    mq->tail = (mq->tail + 1) % mq->max_msgs;
+    mq->count++;
+    mq_leave(mq, key);
+    return BR_OK;
+}
 
-    br_hal_irq_restore(key);
-    br_sched_reschedule();
+br_err_t br_mqueue_peek(br_mqueue_t *mq, void **msg, br_time_t timeout)
+{
+    if (mq == NULL || msg == NULL) {
+        return BR_ERR_INVALID;
+    }
 
-    if (tcb->wait_result == BR_ERR_TIMEOUT) {
-        uint32_t k2 = br_hal_irq_disable();
-        wq_remove(&mq->recv_wait, tcb);
-        br_hal_irq_restore(k2);
-        return BR_ERR_TIMEOUT;
+    uint32_t key = br_hal_irq_disable();
+
+    if (mq_can_get(mq)) {
+        mq->peeked = true;
+        br_hal_irq_restore(key);
+    } else {
+        /* BR_OK: the head message was granted to us */
+        br_err_t err = mq_block(&mq->recv_wait, NULL, timeout, key);
+        if (err != BR_OK) {
+            return err;
+        }
     }
 
-    /* Woken by send — now dequeue the message */
-    key = br_hal_irq_disable();
-    if (mq->count > 0) {
-        uint8_t *src = mq->buffer + (mq->head * mq->msg_size);
-        memcpy(msg, src, mq->msg_size);
-        mq->head = (mq->head + 1) % mq->max_msgs;
-        mq->count--;
+    /* The head cannot move while we hold the peek */
+    *msg = mq->buffer + (mq->head * mq->msg_size);
+    return BR_OK;
+}
+
+br_err_t br_mqueue_release(br_mqueue_t *mq)
+{
+    if (mq == NULL) {
+        return BR_ERR_INVALID;
+    }
+
+    uint32_t key = br_hal_irq_disable();
+
+    if (!mq->peeked) {
+        br_hal_irq_restore(key);
+        return BR_ERR_INVALID;
     }
-    br_hal_irq_restore(key);
 
+    mq->peeked = false;
+    mq->head = (mq->head + 1) % mq->max_msgs;
+    mq->count--;
+    mq_leave(mq, key);
     return BR_OK;
 }
+
+/*
+ * Batches: move as many messages as the queue takes (or holds) in one
+ * critical section, wake everyone that enables and reschedule once.
+ * Below `min`, block for the next message like a single send or recv;
+ * whoever moves it wakes us, and the loop goes on from there.
+ */
+
+br_err_t br_mqueue_send_n(br_mqueue_t *mq, const void *msgs, size_t n,
+                          size_t min, size_t *sent, br_time_t timeout)
+{
+    if (mq == NULL || msgs == NULL || n == 0 || min > n) {
+        return BR_ERR_INVALID;
+    }
+
+    const uint8_t *next = (const uint8_t *)msgs;
+    br_tick_t deadline  = wq_deadline(timeout);
+    br_err_t err        = BR_OK;
+    size_t done         = 0;
+
+    for (;;) {
+        uint32_t key = br_hal_irq_disable();
+        bool woken = false;
+
+        while (done < n) {
+            if (mq->count == 0 && mq->recv_wait != NULL &&
+                mq->recv_wait->wait_buf != NULL) {
+                br_tcb_t *waiter = wq_pop(&mq->recv_wait);
+                memcpy(waiter->wait_buf, next, mq->msg_size);
+                wake_waiter(waiter);
+                woken = true;
+            } else if (mq_can_put(mq)) {
+                mq_put(mq, next);
+            } else {
+                break;
+            }
+            next += mq->msg_size;
+            done++;
+        }
+
+        woken |= mq_serve(mq);
+
+        if (done < min && timeout != 0 && !br_hal_in_isr()) {
+            /* BR_OK: a receiver has already queued this message */
+            err = mq_block_until(&mq->send_wait, (void *)next, deadline, key);
+            if (err != BR_OK) {
+                break;
+            }
+            next += mq->msg_size;
+            done++;
+            continue;
+        }
+
+        br_hal_irq_restore(key);
+        if (woken) {
+            br_sched_reschedule();
+        }
+        if (done < min) {
+            err = timeout == 0 ? BR_ERR_TIMEOUT : BR_ERR_ISR;
+        }
+        break;
+    }
+
+    if (sent != NULL) {
+        *sent = done;
+    }
+    return err;
+}
+
+br_err_t br_mqueue_recv_n(br_mqueue_t *mq, void *msgs, size_t n,
+                          size_t min, size_t *received, br_time_t timeout)
+{
+    if (mq == NULL || msgs == NULL || n == 0 || min > n) {
+        return BR_ERR_INVALID;
+    }
+
+    uint8_t *next      = (uint8_t *)msgs;
+    br_tick_t deadline = wq_deadline(timeout);
+    br_err_t err       = BR_OK;
+    size_t done        = 0;
+
+    for (;;) {
+        uint32_t key = br_hal_irq_disable();
+        bool woken = false;
+
+        /* Each message taken makes room for a blocked sender's, which
+         * joins the ring behind the others and can be taken in turn */
+        while (done < n && mq_can_get(mq)) {
+            mq_get(mq, next);
+            woken |= mq_serve(mq);
+            next += mq->msg_size;
+            done++;
+        }
+
+        if (done < min && timeout != 0 && !br_hal_in_isr()) {
+            /* BR_OK: a sender has already copied this message into next */
+            err = mq_block_until(&mq->recv_wait, next, deadline, key);
+            if (err != BR_OK) {
+                break;
+            }
+            next += mq->msg_size;
+            done++;
+            continue;
+        }
+
+        br_hal_irq_restore(key);
+        if (woken) {
+            br_sched_reschedule();
+        }
+        if (done < min) {
+            err = timeout == 0 ? BR_ERR_TIMEOUT : BR_ERR_ISR;
+        }
+        break;
+    }
+
+    if (received != NULL) {
+        *received = done;
+    }
+    return err;
+}
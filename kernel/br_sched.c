@@ -15,146 +15,947 @@
 
 #include "bedrock/bedrock.h"
 
-/* Per-priority ready queue heads (singly linked list) */
-static br_tcb_t *ready_queue[CONFIG_NUM_PRIORITIES];
+#if CONFIG_SCHED_BUDGET
+extern void br_time_timeout_add(br_tcb_t *tcb, br_tick_t deadline,
+                                br_tick_t slack);
+#endif
+#if !CONFIG_SMP
+extern void br_time_reprogram_alarm(void);
+#endif
 
-/* Pointer to the currently running task */
-static br_tcb_t *current_task;
+/*
+ * Ready queue
+ *
+ * One FIFO per priority level with both head and tail pointers, plus a
+ * bitmap of non-empty levels.  Priority p maps to bit (31 - p % 32) of
+ * word p / 32, so the highest ready priority is found with a single
+ * count-leading-zeros per level of the bitmap.  Above 32 levels a second
+ * summary word records which bitmap words are non-empty, which keeps the
+ * lookup at two CLZs for the full 256-level range.
+ */
 
-/* Scheduler lock depth (for nested critical sections) */
-static volatile uint32_t sched_lock;
+#if CONFIG_NUM_PRIORITIES < 2 || CONFIG_NUM_PRIORITIES > 256
+#error "CONFIG_NUM_PRIORITIES must be between 2 and 256"
+#endif
 
-void br_sched_init(void)
+#if CONFIG_SCHED_EDF && CONFIG_SCHED_EDF_PRIO >= CONFIG_NUM_PRIORITIES - 1
+#error "CONFIG_SCHED_EDF_PRIO must be a higher priority than the idle task"
+#endif
+
+#if CONFIG_SCHED_BUDGET && CONFIG_SMP
+#error "CONFIG_SCHED_BUDGET is not supported with CONFIG_SMP yet"
+#endif
+
+#define PRIO_WORDS      ((CONFIG_NUM_PRIORITIES + 31) / 32)
+#define PRIO_BIT(p)     (0x80000000UL >> ((p) & 31U))
+#define PRIO_WORD(p)    ((p) >> 5)
+
+/*
+ * Run queue -- one per CPU.
+ *
+ * A uniprocessor build has a single run queue and rq_lock() is plain
+ * IRQ disable.  With CONFIG_SMP every CPU owns a run queue protected by
+ * its own spinlock; a task sits on the run queue of tcb->cpu.  Lock
+ * order: the kernel lock taken by br_hal_irq_disable() may be held when
+ * a run queue lock is taken, never the other way round.  A second run
+ * queue lock is only ever try-locked (work stealing).
+ *
+ * On SMP the run queue lock is held across br_hal_context_switch() and
+ * released by the task that is switched in, on whatever CPU that is
+ * (see do_reschedule() and br_sched_finish_switch()).
+ */
+typedef struct {
+#if CONFIG_SMP
+    br_spinlock_t      lock;
+#endif
+    br_tcb_t          *current;       /* Task running on this CPU */
+    br_tcb_t          *idle;          /* This CPU's idle task */
+    br_tcb_t          *head[CONFIG_NUM_PRIORITIES];
+    br_tcb_t          *tail[CONFIG_NUM_PRIORITIES];
+    uint32_t           bits[PRIO_WORDS];
+#if PRIO_WORDS > 1
+    uint32_t           group;
+#endif
+    uint32_t           nr_ready;      /* Queued tasks, current excluded */
+
+    /* Scheduler lock depth (for nested critical sections) */
+    volatile uint32_t  sched_lock;
+
+    /*
+     * Deferred reschedule request.  Kernel calls made from interrupt
+     * context only set this flag; the HAL drains it once on the way out
+     * of the interrupt (PendSV on Cortex-M, signal-handler exit on the
+     * host), so a burst of wakeups inside one ISR costs a single
+     * reschedule.  On SMP it is also how other CPUs request one (IPI).
+     */
+    volatile bool      need_resched;
+} br_rq_t;
+
+static br_rq_t runqueues[CONFIG_NUM_CPUS];
+
+#if CONFIG_SMP
+#  define THIS_CPU()    br_hal_cpu_id()
+#  define task_rq(tcb)  (&runqueues[(tcb)->cpu])
+#else
+#  define THIS_CPU()    0U
+#  define task_rq(tcb)  ((void)(tcb), &runqueues[0])
+#endif
+
+#define this_rq()       (&runqueues[THIS_CPU()])
+
+#if CONFIG_SMP
+
+static inline uint32_t rq_lock(br_rq_t *rq)
+{
+    uint32_t key = br_hal_irq_local_disable();
+    br_hal_spin_lock(&rq->lock);
+    return key;
+}
+
+static inline void rq_unlock(br_rq_t *rq, uint32_t key)
 {
-    for (int i = 0; i < CONFIG_NUM_PRIORITIES; i++) {
-        ready_queue[i] = NULL;
+    br_hal_spin_unlock(&rq->lock);
+    br_hal_irq_local_restore(key);
+}
+
+/* Lock the calling CPU's run queue (IRQs go off first: no migration) */
+static inline br_rq_t *this_rq_lock(uint32_t *key)
+{
+    *key = br_hal_irq_local_disable();
+    br_rq_t *rq = this_rq();
+    br_hal_spin_lock(&rq->lock);
+    return rq;
+}
+
+/* Lock the run queue a task belongs to; tcb->cpu only changes under it */
+static br_rq_t *task_rq_lock(br_tcb_t *tcb, uint32_t *key)
+{
+    for (;;) {
+        br_rq_t *rq = task_rq(tcb);
+        *key = rq_lock(rq);
+        if (rq == task_rq(tcb)) {
+            return rq;
+        }
+        rq_unlock(rq, *key);
     }
-    current_task = NULL;
-    sched_lock = 0;
 }
 
-/* Insert a task into its priority-level ready queue (tail) */
-void br_sched_ready(br_tcb_t *tcb)
+#else
+
+static inline uint32_t rq_lock(br_rq_t *rq)
+{
+    (void)rq;
+    return br_hal_irq_disable();
+}
+
+static inline void rq_unlock(br_rq_t *rq, uint32_t key)
+{
+    (void)rq;
+    br_hal_irq_restore(key);
+}
+
+static inline br_rq_t *this_rq_lock(uint32_t *key)
+{
+    *key = br_hal_irq_disable();
+    return &runqueues[0];
+}
+
+static inline br_rq_t *task_rq_lock(br_tcb_t *tcb, uint32_t *key)
 {
-    uint32_t key = br_hal_irq_disable();
+    (void)tcb;
+    *key = br_hal_irq_disable();
+    return &runqueues[0];
+}
+
+#endif /* CONFIG_SMP */
+
+static inline void prio_mark(br_rq_t *rq, uint8_t prio)
+{
+    rq->bits[PRIO_WORD(prio)] |= PRIO_BIT(prio);
+#if PRIO_WORDS > 1
+    rq->group |= PRIO_BIT(PRIO_WORD(prio));
+#endif
+}
+
+static inline void prio_unmark(br_rq_t *rq, uint8_t prio)
+{
+    rq->bits[PRIO_WORD(prio)] &= ~PRIO_BIT(prio);
+#if PRIO_WORDS > 1
+    if (rq->bits[PRIO_WORD(prio)] == 0) {
+        rq->group &= ~PRIO_BIT(PRIO_WORD(prio));
+    }
+#endif
+}
+
+/* Highest (numerically lowest) priority with a ready task, or -1 */
+static inline int highest_ready_prio(const br_rq_t *rq)
+{
+#if PRIO_WORDS > 1
+    if (rq->group == 0) {
+        return -1;
+    }
+    uint32_t w = (uint32_t)__builtin_clz(rq->group);
+    return (int)((w << 5) + (uint32_t)__builtin_clz(rq->bits[w]));
+#else
+    if (rq->bits[0] == 0) {
+        return -1;
+    }
+    return __builtin_clz(rq->bits[0]);
+#endif
+}
+
+/*
+ * EDF band
+ *
+ * With CONFIG_SCHED_EDF, priority level CONFIG_SCHED_EDF_PRIO holds the
+ * EDF tasks and is kept sorted by absolute deadline instead of FIFO, so
+ * its head is still the task to run and every other level keeps its O(1)
+ * paths.  Only insertion into the band walks the list.
+ */
+#if CONFIG_SCHED_EDF
+#  define IS_EDF_BAND(p)    ((p) == CONFIG_SCHED_EDF_PRIO)
+#else
+#  define IS_EDF_BAND(p)    false
+#endif
+
+/* True if a should run before b */
+static inline bool task_preempts(const br_tcb_t *a, const br_tcb_t *b)
+{
+    if (a->priority != b->priority) {
+        return a->priority < b->priority;
+    }
+#if CONFIG_SCHED_EDF
+    if (IS_EDF_BAND(a->priority)) {
+        return a->abs_deadline < b->abs_deadline;
+    }
+#endif
+    return false;
+}
+
+/* True if a queued task shares cur's level and may take over the CPU
+ * once cur's time slice ends (EDF: an equal or earlier deadline) */
+static inline bool rr_peer_ready(const br_rq_t *rq, const br_tcb_t *cur)
+{
+    const br_tcb_t *head = rq->head[cur->priority];
+    if (head == NULL) {
+        return false;
+    }
+#if CONFIG_SCHED_EDF
+    if (IS_EDF_BAND(cur->priority)) {
+        return head->abs_deadline <= cur->abs_deadline;
+    }
+#endif
+    return true;
+}
+
+/* Append a task to its priority level.  Run queue must be locked. */
+static void enqueue(br_rq_t *rq, br_tcb_t *tcb)
+{
+    uint8_t prio = tcb->priority;
 
     tcb->state = BR_TASK_READY;
     tcb->next  = NULL;
 
+    if (rq->head[prio] == NULL) {
+        rq->head[prio] = tcb;
+        rq->tail[prio] = tcb;
+        prio_mark(rq, prio);
+    } else if (IS_EDF_BAND(prio)) {
+#if CONFIG_SCHED_EDF
+        /* Behind every task with an earlier or equal deadline */
+        br_tcb_t **pp = &rq->head[prio];
+        while (*pp != NULL && (*pp)->abs_deadline <= tcb->abs_deadline) {
+            pp = &((*pp)->next);
+        }
+        tcb->next = *pp;
+        *pp = tcb;
+        if (tcb->next == NULL) {
+            rq->tail[prio] = tcb;
+        }
+#endif
+    } else {
+        rq->tail[prio]->next = tcb;
+        rq->tail[prio] = tcb;
+    }
+    rq->nr_ready++;
+}
+
+/*
+ * Put a preempted task back at the head of its level, so that it runs
+ * again before its peers (POSIX SCHED_FIFO/SCHED_RR).  In the EDF band it
+ * goes ahead of the tasks with an equal deadline instead.  Run queue must
+ * be locked.
+ */
+static void enqueue_head(br_rq_t *rq, br_tcb_t *tcb)
+{
     uint8_t prio = tcb->priority;
 
-    if (ready_queue[prio] == NULL) {
-        ready_queue[prio] = tcb;
-    } else {
-        br_tcb_t *tail = ready_queue[prio];
-        while (tail->next != NULL) {
-            tail = tail->next;
-        }
-        tail->next = tcb;
+    if (rq->head[prio] == NULL) {
+        enqueue(rq, tcb);
+        return;
     }
 
-    br_hal_irq_restore(key);
+    tcb->state = BR_TASK_READY;
+    br_tcb_t **pp = &rq->head[prio];
+#if CONFIG_SCHED_EDF
+    if (IS_EDF_BAND(prio)) {
+        while (*pp != NULL && (*pp)->abs_deadline < tcb->abs_deadline) {
+            pp = &((*pp)->next);
+        }
+    }
+#endif
+    tcb->next = *pp;
+    *pp = tcb;
+    if (tcb->next == NULL) {
+        rq->tail[prio] = tcb;
+    }
+    rq->nr_ready++;
 }
 
-/* Remove a specific task from its ready queue */
-void br_sched_unready(br_tcb_t *tcb)
+/* Unlink a task from its priority level.  Run queue must be locked. */
+static void dequeue(br_rq_t *rq, br_tcb_t *tcb)
 {
-    uint32_t key = br_hal_irq_disable();
-
     uint8_t prio = tcb->priority;
-    br_tcb_t **pp = &ready_queue[prio];
+    br_tcb_t *prev = NULL;
+    br_tcb_t **pp = &rq->head[prio];
 
     while (*pp != NULL) {
         if (*pp == tcb) {
             *pp = tcb->next;
+            if (rq->tail[prio] == tcb) {
+                rq->tail[prio] = prev;
+            }
+            if (rq->head[prio] == NULL) {
+                prio_unmark(rq, prio);
+            }
             tcb->next = NULL;
-            break;
+            rq->nr_ready--;
+            return;
         }
+        prev = *pp;
         pp = &((*pp)->next);
     }
+}
 
-    br_hal_irq_restore(key);
+/* Pop the highest-priority ready task.  Run queue must be locked. */
+static br_tcb_t *pick_next(br_rq_t *rq)
+{
+    int prio = highest_ready_prio(rq);
+    if (prio < 0) {
+        return NULL;
+    }
+
+    br_tcb_t *tcb = rq->head[prio];
+    rq->head[prio] = tcb->next;
+    if (rq->head[prio] == NULL) {
+        rq->tail[prio] = NULL;
+        prio_unmark(rq, (uint8_t)prio);
+    }
+    tcb->next = NULL;
+    rq->nr_ready--;
+    return tcb;
 }
 
-/* Find the highest-priority ready task */
-static br_tcb_t *pick_next(void)
+/* Ask a CPU to run its deferred reschedule */
+static void request_resched(uint32_t cpu)
 {
-    for (int prio = 0; prio < CONFIG_NUM_PRIORITIES; prio++) {
-        if (ready_queue[prio] != NULL) {
-            br_tcb_t *tcb = ready_queue[prio];
-            ready_queue[prio] = tcb->next;
-            tcb->next = NULL;
-            return tcb;
+    runqueues[cpu].need_resched = true;
+#if CONFIG_SMP
+    if (cpu != THIS_CPU()) {
+        br_hal_ipi_send(cpu);
+        return;
+    }
+#endif
+    br_hal_pend_reschedule();
+}
+
+#if CONFIG_SMP
+
+/* Wake one CPU that is running its idle task so it can steal work */
+static void kick_idle_cpu(uint32_t except)
+{
+    for (uint32_t cpu = 0; cpu < CONFIG_NUM_CPUS; cpu++) {
+        br_rq_t *rq = &runqueues[cpu];
+        if (cpu != except && rq->idle != NULL && rq->current == rq->idle) {
+            request_resched(cpu);
+            return;
+        }
+    }
+}
+
+/* True if, without stealing, this CPU would go (or stay) idle */
+static bool rq_would_idle(const br_rq_t *rq, const br_tcb_t *prev)
+{
+    uint32_t queued = rq->nr_ready;
+    if (rq->idle != NULL && rq->idle != prev) {
+        queued--;                       /* The idle task itself */
+    }
+    return queued == 0 &&
+           (prev == NULL || prev == rq->idle || prev->state != BR_TASK_RUNNING);
+}
+
+/* Highest-priority task on a victim run queue that may migrate */
+static br_tcb_t *find_stealable(const br_rq_t *victim)
+{
+    for (uint32_t w = 0; w < PRIO_WORDS; w++) {
+        uint32_t bits = victim->bits[w];
+        while (bits != 0) {
+            uint32_t b = (uint32_t)__builtin_clz(bits);
+            for (br_tcb_t *t = victim->head[(w << 5) + b]; t != NULL; t = t->next) {
+                if (t != victim->current && t != victim->idle) {
+                    return t;
+                }
+            }
+            bits &= ~PRIO_BIT(b);
         }
     }
     return NULL;
 }
 
+/*
+ * Work stealing: move the best migratable task of the first busy CPU
+ * found onto our own run queue.  Called with our run queue locked; the
+ * victim is only try-locked, so two stealing CPUs cannot deadlock.
+ */
+static void steal_task(br_rq_t *rq, uint32_t self)
+{
+    for (uint32_t i = 1; i < CONFIG_NUM_CPUS; i++) {
+        uint32_t cpu = (self + i) % CONFIG_NUM_CPUS;
+        br_rq_t *victim = &runqueues[cpu];
+
+        if (victim->nr_ready == 0 || !br_hal_spin_trylock(&victim->lock)) {
+            continue;
+        }
+
+        br_tcb_t *tcb = find_stealable(victim);
+        if (tcb != NULL) {
+            dequeue(victim, tcb);
+            tcb->cpu = (uint8_t)self;
+            enqueue(rq, tcb);
+        }
+
+        br_hal_spin_unlock(&victim->lock);
+
+        if (tcb != NULL) {
+            return;
+        }
+    }
+}
+
+#endif /* CONFIG_SMP */
+
+/*
+ * CPU budgets
+ *
+ * A budgeted task is charged for the CPU time between being switched in
+ * (or last charged) and the next reschedule.  While it runs, the one-shot
+ * alarm is programmed for the moment its budget would run out (see
+ * br_sched_next_event()); the alarm's reschedule then finds the budget
+ * used up and throttles the task: it sleeps on the ordinary sleep list
+ * until its budget is replenished.  A period starts when a task runs on
+ * a full budget, so idle time is never banked (sporadic server).
+ */
+#if CONFIG_SCHED_BUDGET
+
+br_err_t br_budget_init(br_budget_t *b, br_time_t budget, br_time_t period)
+{
+    if (b == NULL || budget == 0 || budget > period ||
+        br_us_to_ticks(period) == BR_TICK_INFINITE) {
+        return BR_ERR_INVALID;
+    }
+    b->budget    = br_us_to_ticks(budget);
+    b->period    = br_us_to_ticks(period);
+    b->remaining = b->budget;
+    b->replenish = 0;
+    return BR_OK;
+}
+
+static void budget_charge(br_tcb_t *tcb, br_tick_t now)
+{
+    br_budget_t *b = tcb->budget;
+    br_tick_t used = now - tcb->exec_start;
+
+    b->remaining  = used < b->remaining ? b->remaining - used : 0;
+    tcb->exec_start = now;
+}
+
+/* Put a task to sleep until its budget's next replenishment */
+static void budget_throttle(br_tcb_t *tcb)
+{
+    tcb->state = BR_TASK_BLOCKED;
+    br_time_timeout_add(tcb, tcb->budget->replenish, 0);
+}
+
+/*
+ * Throttle picked tasks whose budget is used up until one may run.
+ * Run queue must be locked.
+ */
+static br_tcb_t *budget_admit(br_rq_t *rq, br_tcb_t *next, br_tick_t *now)
+{
+    while (next != NULL && next->budget != NULL) {
+        br_budget_t *b = next->budget;
+
+        if (*now == 0) {
+            *now = br_hal_timer_get_ticks();
+        }
+        if (*now >= b->replenish) {
+            b->remaining = b->budget;
+            b->replenish = *now + b->period;
+        }
+        if (b->remaining != 0) {
+            break;
+        }
+
+        budget_throttle(next);
+        next = pick_next(rq);
+    }
+    return next;
+}
+
+#endif /* CONFIG_SCHED_BUDGET */
+
+#if CONFIG_TASK_STATS
+/*
+ * Charge prev for its time on the CPU, noting how it left; start next.
+ * involuntary is decided by the caller before a used-up budget blocks prev.
+ */
+static void stats_switch(br_tcb_t *prev, br_tcb_t *next, br_tick_t now,
+                         bool involuntary)
+{
+    if (prev != NULL) {
+        prev->stats.runtime += now - prev->run_start;
+        if (involuntary) {
+            prev->stats.preemptions++;
+        } else {
+            prev->stats.voluntary++;
+        }
+        prev->yielded = false;
+    }
+    next->stats.switches++;
+    next->run_start = now;
+}
+#endif
+
+/* Start a fresh time slice for a task being switched in */
+static inline void slice_start(br_tcb_t *tcb, br_tick_t now)
+{
+    tcb->slice_end = tcb->policy == BR_POLICY_FIFO ? BR_TICK_INFINITE
+                                                   : now + tcb->time_slice;
+}
+
+/*
+ * Scheduler events (uniprocessor)
+ *
+ * The running task's budget exhaustion and -- only while a peer at its
+ * priority is ready to take over -- the end of its round-robin slice are
+ * folded into the one-shot alarm.  A task running alone or under
+ * BR_POLICY_FIFO arms nothing.  The slice itself is accounted by
+ * br_sched_tick() in the timer interrupt, so SMP builds, which do not
+ * share the alarm, still slice on the HAL's periodic interrupt.
+ */
+#if !CONFIG_SMP
+
+static bool sched_event_armed;   /* The alarm may carry a scheduler event */
+
+/* Absolute time of the running task's next scheduler event, or
+ * BR_TICK_INFINITE.  Called by br_time_reprogram_alarm(). */
+br_tick_t br_sched_next_event(void)
+{
+    const br_rq_t *rq = &runqueues[0];
+    const br_tcb_t *cur = rq->current;
+    br_tick_t next = BR_TICK_INFINITE;
+
+    if (cur != NULL && cur->state == BR_TASK_RUNNING) {
+#if CONFIG_SCHED_BUDGET
+        if (cur->budget != NULL) {
+            next = cur->exec_start + cur->budget->remaining;
+        }
+#endif
+        if (cur->policy == BR_POLICY_RR && cur->slice_end < next &&
+            rr_peer_ready(rq, cur)) {
+            next = cur->slice_end;
+        }
+    }
+
+    sched_event_armed = next != BR_TICK_INFINITE;
+    return next;
+}
+
+/* Reprogram the alarm if the running task has or had an event */
+static void sched_event_rearm(void)
+{
+    if (sched_event_armed || br_sched_next_event() != BR_TICK_INFINITE) {
+        br_time_reprogram_alarm();
+    }
+}
+
+#endif /* !CONFIG_SMP */
+
+void br_sched_init(void)
+{
+    for (int cpu = 0; cpu < CONFIG_NUM_CPUS; cpu++) {
+        br_rq_t *rq = &runqueues[cpu];
+
+        for (int i = 0; i < CONFIG_NUM_PRIORITIES; i++) {
+            rq->head[i] = NULL;
+            rq->tail[i] = NULL;
+        }
+        for (int i = 0; i < PRIO_WORDS; i++) {
+            rq->bits[i] = 0;
+        }
+#if PRIO_WORDS > 1
+        rq->group = 0;
+#endif
+#if CONFIG_SMP
+        rq->lock.locked = 0;
+#endif
+        rq->current      = NULL;
+        rq->idle         = NULL;
+        rq->nr_ready     = 0;
+        rq->sched_lock   = 0;
+        rq->need_resched = false;
+    }
+}
+
+/* Insert a task into its priority-level ready queue (tail) */
+void br_sched_ready(br_tcb_t *tcb)
+{
+    uint32_t key;
+    br_rq_t *rq = task_rq_lock(tcb, &key);
+
+#if CONFIG_SCHED_EDF
+    /* An aperiodic EDF task waking after its deadline starts a new job,
+     * whose deadline counts from now.  Before that the wakeup ends a
+     * block inside the current job, which keeps its deadline.  Periodic
+     * tasks move theirs in br_task_wait_next_period(). */
+    if (tcb->sched_class == BR_SCHED_EDF && tcb->period == 0 &&
+        (tcb->state == BR_TASK_BLOCKED || tcb->state == BR_TASK_SUSPENDED)) {
+        br_tick_t now = br_hal_timer_get_ticks();
+        if (now >= tcb->abs_deadline) {
+            tcb->release      = now;
+            tcb->abs_deadline = now + tcb->rel_deadline;
+        }
+    }
+#endif
+
+    enqueue(rq, tcb);
+
+#if CONFIG_SMP
+    /* The caller reschedules its own CPU; other CPUs need an IPI */
+    if (rq->current != NULL && task_preempts(tcb, rq->current)) {
+        if (tcb->cpu != THIS_CPU()) {
+            request_resched(tcb->cpu);
+        }
+    } else {
+        kick_idle_cpu(tcb->cpu);
+    }
+#else
+    /* First peer of a time-sliced running task: arm its slice end */
+    br_tcb_t *cur = rq->current;
+    if (cur != NULL && cur != tcb && cur->policy == BR_POLICY_RR &&
+        cur->priority == tcb->priority && rq->head[tcb->priority] == tcb) {
+        br_time_reprogram_alarm();
+    }
+#endif
+
+    rq_unlock(rq, key);
+}
+
+/* Remove a specific task from its ready queue */
+void br_sched_unready(br_tcb_t *tcb)
+{
+    uint32_t key;
+    br_rq_t *rq = task_rq_lock(tcb, &key);
+
+    dequeue(rq, tcb);
+
+    rq_unlock(rq, key);
+}
+
 /* Forward declarations */
 void br_sched_reschedule(void);
+static void do_reschedule(void);
 
 void br_sched_lock(void)
 {
-    uint32_t key = br_hal_irq_disable();
-    sched_lock++;
-    br_hal_irq_restore(key);
+    uint32_t key;
+    br_rq_t *rq = this_rq_lock(&key);
+    rq->sched_lock++;
+    rq_unlock(rq, key);
 }
 
 void br_sched_unlock(void)
 {
-    uint32_t key = br_hal_irq_disable();
-    if (sched_lock > 0) {
-        sched_lock--;
+    uint32_t key;
+    br_rq_t *rq = this_rq_lock(&key);
+    if (rq->sched_lock > 0) {
+        rq->sched_lock--;
     }
-    br_hal_irq_restore(key);
-    if (sched_lock == 0) {
+    uint32_t depth = rq->sched_lock;
+    rq_unlock(rq, key);
+    if (depth == 0) {
         br_sched_reschedule();
     }
 }
 
 br_tcb_t *br_sched_current(void)
 {
-    return current_task;
+#if CONFIG_SMP
+    uint32_t key = br_hal_irq_local_disable();
+    br_tcb_t *cur = this_rq()->current;
+    br_hal_irq_local_restore(key);
+    return cur;
+#else
+    return runqueues[0].current;
+#endif
 }
 
 void br_sched_set_current(br_tcb_t *tcb)
 {
-    current_task = tcb;
+    this_rq()->current = tcb;
+}
+
+/* True if tcb is the task a CPU is executing right now */
+bool br_sched_task_on_cpu(br_tcb_t *tcb)
+{
+    return task_rq(tcb)->current == tcb;
+}
+
+/*
+ * Take a task off the CPU: dequeue it if it is waiting to run, and if it
+ * is executing on another CPU make that CPU switch away.  The caller
+ * reschedules when tcb is the calling task.
+ */
+void br_sched_suspend(br_tcb_t *tcb)
+{
+    uint32_t key;
+    br_rq_t *rq = task_rq_lock(tcb, &key);
+
+    if (tcb->state == BR_TASK_READY) {
+        dequeue(rq, tcb);
+    }
+    tcb->state = BR_TASK_SUSPENDED;
+
+#if CONFIG_SMP
+    if (rq->current == tcb && tcb->cpu != THIS_CPU()) {
+        request_resched(tcb->cpu);
+    }
+#endif
+
+    rq_unlock(rq, key);
+}
+
+/*
+ * Change a task's effective priority (priority inheritance).  A queued
+ * task moves to its new level; on SMP, a CPU whose running task is
+ * affected is asked to reschedule.  The caller reschedules its own CPU.
+ */
+void br_sched_set_priority(br_tcb_t *tcb, uint8_t prio)
+{
+    uint32_t key;
+    br_rq_t *rq = task_rq_lock(tcb, &key);
+
+    if (tcb->state == BR_TASK_READY) {
+        dequeue(rq, tcb);
+        tcb->priority = prio;
+        enqueue(rq, tcb);
+    } else {
+        tcb->priority = prio;
+    }
+
+#if CONFIG_SMP
+    if (tcb->cpu != THIS_CPU() && rq->current != NULL &&
+        (rq->current == tcb || task_preempts(tcb, rq->current))) {
+        request_resched(tcb->cpu);
+    }
+#endif
+
+    rq_unlock(rq, key);
+}
+
+/* Register a CPU's idle task; it never migrates to another CPU */
+void br_sched_set_idle(uint32_t cpu, br_tcb_t *tcb)
+{
+    br_sched_unready(tcb);
+#if CONFIG_SMP
+    tcb->cpu = (uint8_t)cpu;
+#endif
+    runqueues[cpu].idle = tcb;
+    br_sched_ready(tcb);
+}
+
+#if CONFIG_SMP
+/* Least-loaded CPU; new tasks are placed there */
+uint32_t br_sched_select_cpu(void)
+{
+    uint32_t best = 0;
+    uint32_t best_load = UINT32_MAX;
+
+    for (uint32_t cpu = 0; cpu < CONFIG_NUM_CPUS; cpu++) {
+        const br_rq_t *rq = &runqueues[cpu];
+        uint32_t load = rq->nr_ready;
+        if (rq->current != NULL && rq->current != rq->idle) {
+            load++;
+        }
+        if (load < best_load) {
+            best = cpu;
+            best_load = load;
+        }
+    }
+    return best;
+}
+#endif
+
+uint32_t br_cpu_id(void)
+{
+    return THIS_CPU();
 }
 
 void br_sched_reschedule(void)
 {
-    if (sched_lock > 0) {
+    if (br_hal_in_isr()) {
+        br_rq_t *rq = this_rq();
+        if (!rq->need_resched) {
+            request_resched(THIS_CPU());
+        }
         return;
     }
 
-    uint32_t key = br_hal_irq_disable();
+    do_reschedule();
+}
+
+/*
+ * Called by the HAL once per interrupt exit.  Performs the reschedule
+ * that ISR-context kernel calls (or, on SMP, other CPUs) deferred, if any.
+ */
+void br_sched_isr_exit(void)
+{
+    br_rq_t *rq = this_rq();
+    if (!rq->need_resched) {
+        return;
+    }
+    rq->need_resched = false;
+    do_reschedule();
+}
 
-    br_tcb_t *next = pick_next();
-    if (next == NULL || next == current_task) {
-        if (next != NULL) {
-            br_sched_ready(next);
+static void do_reschedule(void)
+{
+    uint32_t key;
+    br_rq_t *rq = this_rq_lock(&key);
+
+    if (rq->sched_lock > 0) {
+        rq_unlock(rq, key);
+        return;
+    }
+
+    br_tcb_t *prev = rq->current;
+    br_tick_t now = 0;
+
+#if CONFIG_TASK_STATS
+    /* Throttling blocks prev below, but it did not give up the CPU */
+    bool involuntary = prev != NULL && prev->state == BR_TASK_RUNNING &&
+                       !prev->yielded;
+#endif
+
+#if CONFIG_SCHED_BUDGET
+    if (prev != NULL && prev->budget != NULL) {
+        now = br_hal_timer_get_ticks();
+        budget_charge(prev, now);
+        if (prev->state == BR_TASK_RUNNING && prev->budget->remaining == 0) {
+            budget_throttle(prev);
+        }
+    }
+#endif
+
+#if CONFIG_SMP
+    if (rq_would_idle(rq, prev)) {
+        steal_task(rq, THIS_CPU());
+    }
+#endif
+
+    /*
+     * Fast path: a running task keeps the CPU unless a strictly higher
+     * priority is ready, or a same-priority peer is ready and the task
+     * has used up (or yielded) its time slice.  Decided from the bitmap
+     * alone -- no list is touched, and the task keeps its place.  In the
+     * EDF band the peer must also have an earlier deadline, or an equal
+     * one once the slice is used up.  A used-up slice is not renewed here:
+     * a round-robin task that yielded alone gives way to the next peer.
+     */
+    if (prev != NULL && prev->state == BR_TASK_RUNNING) {
+        int top = highest_ready_prio(rq);
+        if (top < 0 || top > prev->priority ||
+            (top == prev->priority &&
+             (prev->slice_end != 0 || !rr_peer_ready(rq, prev)) &&
+             !task_preempts(rq->head[top], prev))) {
+            if (prev->policy == BR_POLICY_FIFO) {
+                prev->slice_end = BR_TICK_INFINITE;
+            }
+#if CONFIG_TASK_STATS
+            prev->yielded = false;
+#endif
+            rq_unlock(rq, key);
+            return;
         }
-        br_hal_irq_restore(key);
+    }
+
+    br_tcb_t *next = pick_next(rq);
+#if CONFIG_SCHED_BUDGET
+    next = budget_admit(rq, next, &now);
+#endif
+    if (next == NULL) {
+        rq_unlock(rq, key);
         return;
     }
 
-    br_tcb_t *prev = current_task;
+    /* Current task was made ready again before it got switched out */
+    if (next == prev) {
+        next->state = BR_TASK_RUNNING;
+#if CONFIG_TASK_STATS
+        next->yielded = false;
+#endif
+#if !CONFIG_SMP
+        sched_event_rearm();
+#endif
+        rq_unlock(rq, key);
+        return;
+    }
 
     /* Check stack overflow on outgoing task before context switch */
     if (prev != NULL) {
         br_hal_check_stack_overflow(prev);
     }
 
+    if (now == 0) {
+        now = br_hal_timer_get_ticks();
+    }
+#if CONFIG_TASK_STATS
+    stats_switch(prev, next, now, involuntary);
+#endif
+
+    /* A task that yielded or used up its slice goes behind its peers;
+     * one preempted from above keeps its place at the front */
     if (prev != NULL && prev->state == BR_TASK_RUNNING) {
-        prev->state = BR_TASK_READY;
-        prev->rr_remaining = 0;  /* Reset time slice when preempted */
-        br_sched_ready(prev);
+        if (prev->slice_end == 0) {
+            enqueue(rq, prev);
+        } else {
+            enqueue_head(rq, prev);
+        }
     }
 
-    next->state  = BR_TASK_RUNNING;
-    next->rr_remaining = CONFIG_RR_TIME_SLICE_US;  /* Initialize time slice */
-    current_task = next;
+    next->state = BR_TASK_RUNNING;
+    slice_start(next, now);
+    rq->current = next;
+
+#if CONFIG_SCHED_BUDGET
+    if (next->budget != NULL) {
+        next->exec_start = now;
+    }
+#endif
+#if !CONFIG_SMP
+    /* Arm (or drop) the alarm for the incoming task's events */
+    sched_event_rearm();
+#endif
 
     if (prev != NULL) {
         /* Pend PendSV while IRQs are still disabled.
@@ -163,49 +964,149 @@ void br_sched_reschedule(void)
         br_hal_context_switch(&prev->sp, &next->sp);
     }
 
-    br_hal_irq_restore(key);
+#if CONFIG_SMP
+    /* prev may have been resumed on another CPU: release the run queue
+     * of the CPU we are on now, which the switching task left locked. */
+    rq = this_rq();
+#endif
+    rq_unlock(rq, key);
+}
+
+#if CONFIG_SMP
+/*
+ * Called by the HAL when a task runs for the first time: it was switched
+ * to with a run queue lock held and IRQs off (see do_reschedule()).
+ */
+void br_sched_finish_switch(void)
+{
+    br_hal_spin_unlock(&this_rq()->lock);
+    br_hal_irq_local_restore(0);
 }
+#endif
 
 void br_task_yield(void)
 {
+    uint32_t key;
+    br_rq_t *rq = this_rq_lock(&key);
+    if (rq->current != NULL) {
+        rq->current->slice_end = 0;  /* Give up the rest of the slice */
+#if CONFIG_TASK_STATS
+        rq->current->yielded = true;
+#endif
+    }
+    rq_unlock(rq, key);
+
     br_sched_reschedule();
 }
 
-void br_sched_start(void)
+/* Pick and start this CPU's first task; never returns */
+static void start_cpu(void (*start_secondaries)(void))
 {
-    br_tcb_t *first = pick_next();
+#if CONFIG_SMP
+    /* Left locked: the first task releases it in br_sched_finish_switch() */
+    uint32_t key;
+    br_rq_t *rq = this_rq_lock(&key);
+    (void)key;
+#else
+    br_rq_t *rq = this_rq();
+#endif
+
+    br_tcb_t *first = pick_next(rq);
+    br_tick_t now = 0;
+#if CONFIG_SCHED_BUDGET
+    first = budget_admit(rq, first, &now);
+#endif
     if (first == NULL) {
         while (1) { }
     }
 
+    if (now == 0) {
+        now = br_hal_timer_get_ticks();
+    }
+#if CONFIG_TASK_STATS
+    stats_switch(NULL, first, now, false);
+#endif
     first->state = BR_TASK_RUNNING;
-    first->rr_remaining = CONFIG_RR_TIME_SLICE_US;
-    current_task = first;
+    slice_start(first, now);
+    rq->current = first;
+
+#if CONFIG_SCHED_BUDGET
+    if (first->budget != NULL) {
+        first->exec_start = now;
+    }
+#endif
+#if !CONFIG_SMP
+    sched_event_rearm();
+#endif
+
+    if (start_secondaries != NULL) {
+        start_secondaries();
+    }
 
     br_hal_start_first_task(first->sp);
 }
 
-/* Called from timer ISR to handle round-robin time slicing */
-void br_sched_tick(br_time_t elapsed_us)
+#if CONFIG_SMP
+static void start_secondary_cpu(void)
 {
-    if (current_task == NULL) {
-        return;
-    }
+    start_cpu(NULL);
+}
 
-    /* Decrement remaining time slice */
-    if (current_task->rr_remaining > elapsed_us) {
-        current_task->rr_remaining -= elapsed_us;
-    } else {
-        current_task->rr_remaining = 0;
-        
-        /* Time slice expired - check if there are other tasks at same priority */
-        uint8_t prio = current_task->priority;
-        if (ready_queue[prio] != NULL) {
-            /* There are other ready tasks at this priority - preempt */
-            br_sched_reschedule();
-        } else {
-            /* No other tasks at this priority - renew time slice */
-            current_task->rr_remaining = CONFIG_RR_TIME_SLICE_US;
+static void start_secondaries(void)
+{
+    br_hal_smp_start(start_secondary_cpu);
+}
+#endif
+
+void br_sched_start(void)
+{
+#if CONFIG_SMP
+    start_cpu(start_secondaries);
+#else
+    start_cpu(NULL);
+#endif
+}
+
+/*
+ * Called from the timer ISR with the current time to end expired
+ * round-robin slices.  The preemption itself is deferred to
+ * br_sched_isr_exit().  On SMP the one timer interrupt checks the slice
+ * of every CPU's running task.
+ */
+void br_sched_tick(br_tick_t now)
+{
+#if CONFIG_SMP
+    bool backlog = false;
+#endif
+
+    for (uint32_t cpu = 0; cpu < CONFIG_NUM_CPUS; cpu++) {
+        br_rq_t *rq = &runqueues[cpu];
+        uint32_t key = rq_lock(rq);
+        br_tcb_t *cur = rq->current;
+
+#if CONFIG_SMP
+        /* Queued work besides the idle task that another CPU could take */
+        if (rq->nr_ready > (cur == rq->idle ? 0U : 1U)) {
+            backlog = true;
         }
+#endif
+
+        /* Slice expired with other ready tasks at this priority; a task
+         * running alone keeps the CPU until a peer shows up */
+        if (cur != NULL && cur->state == BR_TASK_RUNNING &&
+            cur->policy == BR_POLICY_RR && now >= cur->slice_end &&
+            rr_peer_ready(rq, cur)) {
+            cur->slice_end = 0;
+            request_resched(cpu);
+        }
+
+        rq_unlock(rq, key);
+    }
+
+#if CONFIG_SMP
+    /* Periodic balancing: an idle CPU only steals when asked to */
+    if (backlog) {
+        kick_idle_cpu(CONFIG_NUM_CPUS);
     }
+#endif
 }
@@ -21,37 +21,115 @@ extern void     br_sched_unready(br_tcb_t *tcb);
 extern void     br_sched_reschedule(void);
 extern void     br_sched_start(void);
 extern br_tcb_t *br_sched_current(void);
-extern void     br_time_sleep_list_remove(br_tcb_t *tcb);
+extern void     br_sched_suspend(br_tcb_t *tcb);
+extern bool     br_sched_task_on_cpu(br_tcb_t *tcb);
+extern void     br_sched_set_idle(uint32_t cpu, br_tcb_t *tcb);
+#if CONFIG_SMP
+extern uint32_t br_sched_select_cpu(void);
+#endif
+extern void     br_time_timeout_remove(br_tcb_t *tcb);
+extern void     br_time_sleep_until(br_tick_t until, br_tick_t slack);
+extern void     br_ipc_abort_wait(br_tcb_t *tcb);
+#if CONFIG_TIMERS
+extern void     br_timer_service_init(void);
+#endif
+#if CONFIG_PM
+extern void     br_time_idle(void);
+#endif
 
 /* Static TCB pool (zero dynamic memory) */
 static br_tcb_t tcb_pool[CONFIG_MAX_TASKS];
 
-static uint8_t idle_stack[CONFIG_DEFAULT_STACK_SIZE];
+/* Inactive TCBs, linked through tcb->next */
+static br_tcb_t *tcb_free;
 
+/*
+ * A task ID is the TCB's pool index in the low TID_INDEX_BITS bits and
+ * the slot's generation above them.  Deleting a task bumps the
+ * generation, so an ID kept after its task was deleted no longer
+ * matches the slot, even once the slot is reused.  With at most 65536
+ * tasks the generation keeps 16 of the 32 bits or more.
+ */
+
+#define TID_INDEX_BITS  (32 - __builtin_clz((unsigned)CONFIG_MAX_TASKS - 1U))
+#define TID_INDEX_MASK  ((1U << TID_INDEX_BITS) - 1U)
+
+/* The task with ID tid, or NULL if there is none */
+static br_tcb_t *tcb_lookup(br_tid_t tid)
+{
+    uint32_t index = tid & TID_INDEX_MASK;
+
+    if (index >= CONFIG_MAX_TASKS) {
+        return NULL;
+    }
+
+    br_tcb_t *tcb = &tcb_pool[index];
+    if (tcb->id != tid || tcb->state == BR_TASK_INACTIVE) {
+        return NULL;
+    }
+    return tcb;
+}
+
+/* One idle task per CPU */
+static uint8_t idle_stack[CONFIG_NUM_CPUS][CONFIG_DEFAULT_STACK_SIZE];
+
+static br_idle_hook_t volatile idle_hook;
+
+/*
+ * Run the idle hook while it has work, then sleep the CPU.  Any interrupt
+ * that makes a task ready switches away from here on its way out, so the
+ * loop only comes round again after interrupts that did not.
+ */
 static void idle_entry(void *arg)
 {
     (void)arg;
-    while (1) { }
+    while (1) {
+        br_idle_hook_t hook = idle_hook;
+        if (hook != NULL && hook()) {
+            continue;
+        }
+#if CONFIG_PM
+        br_time_idle();
+#else
+        br_hal_cpu_idle();
+#endif
+    }
+}
+
+void br_set_idle_hook(br_idle_hook_t hook)
+{
+    idle_hook = hook;
 }
 
 void br_kernel_init(void)
 {
-    for (int i = 0; i < CONFIG_MAX_TASKS; i++) {
+    /* Pushed in reverse, so slots are first handed out in index order */
+    tcb_free = NULL;
+    for (int i = CONFIG_MAX_TASKS - 1; i >= 0; i--) {
         tcb_pool[i].state = BR_TASK_INACTIVE;
         tcb_pool[i].id    = (br_tid_t)i;
+        tcb_pool[i].next  = tcb_free;
+        tcb_free = &tcb_pool[i];
     }
 
     br_hal_board_init();
     br_hal_timer_init();
     br_sched_init();
 
-    br_tid_t idle_tid;
-    br_err_t err = br_task_create(&idle_tid, "idle", idle_entry, NULL,
-                                   CONFIG_NUM_PRIORITIES - 1,
-                                   idle_stack, sizeof(idle_stack));
-    if (err != BR_OK) {
-        while (1) { } /* Fatal: cannot create idle task */
+    for (uint32_t cpu = 0; cpu < CONFIG_NUM_CPUS; cpu++) {
+        br_tid_t idle_tid;
+        br_err_t err = br_task_create(&idle_tid, "idle", idle_entry, NULL,
+                                       CONFIG_NUM_PRIORITIES - 1,
+                                       idle_stack[cpu], sizeof(idle_stack[cpu]));
+        if (err != BR_OK) {
+            while (1) { } /* Fatal: cannot create idle task */
+        }
+        br_sched_set_idle(cpu, tcb_lookup(idle_tid));
     }
+
+#if CONFIG_TIMERS
+    br_timer_service_init();
+#endif
 }
 
 void br_kernel_start(void)
@@ -68,37 +146,125 @@ br_err_t br_task_create(br_tid_t *tid,
                         void *stack,
                         size_t stack_size)
 {
-    if (entry == NULL || stack == NULL || stack_size == 0) {
+    br_task_attr_t attr;
+    br_task_attr_init(&attr);
+    attr.name     = name;
+    attr.priority = priority;
+
+    return br_task_create_attr(tid, &attr, entry, arg, stack, stack_size);
+}
+
+static bool attr_valid(const br_task_attr_t *attr)
+{
+    if (attr->policy != BR_POLICY_RR && attr->policy != BR_POLICY_FIFO) {
+        return false;
+    }
+
+    switch (attr->sched_class) {
+    case BR_SCHED_PRIO:
+#if CONFIG_NUM_PRIORITIES < 256
+        if (attr->priority >= CONFIG_NUM_PRIORITIES) {
+            return false;
+        }
+#endif
+#if CONFIG_SCHED_EDF
+        /* The EDF band is reserved for EDF tasks */
+        if (attr->priority == CONFIG_SCHED_EDF_PRIO) {
+            return false;
+        }
+#endif
+        return true;
+
+#if CONFIG_SCHED_EDF
+    case BR_SCHED_EDF:
+        return attr->deadline != 0 &&
+               (attr->period == 0 || attr->deadline <= attr->period);
+#endif
+
+    default:
+        return false;
+    }
+}
+
+br_err_t br_task_create_attr(br_tid_t *tid,
+                             const br_task_attr_t *attr,
+                             br_task_entry_t entry,
+                             void *arg,
+                             void *stack,
+                             size_t stack_size)
+{
+    if (attr == NULL || entry == NULL || stack == NULL || stack_size == 0) {
         return BR_ERR_INVALID;
     }
-    if (priority >= CONFIG_NUM_PRIORITIES) {
+    if (!attr_valid(attr)) {
         return BR_ERR_INVALID;
     }
+#if !CONFIG_SCHED_BUDGET
+    if (attr->budget != NULL) {
+        return BR_ERR_INVALID;
+    }
+#endif
 
     uint32_t key = br_hal_irq_disable();
 
-    /* Find first free TCB slot */
-    br_tcb_t *tcb = NULL;
-    for (int i = 0; i < CONFIG_MAX_TASKS; i++) {
-        if (tcb_pool[i].state == BR_TASK_INACTIVE) {
-            tcb = &tcb_pool[i];
-            break;
-        }
-    }
-
+    br_tcb_t *tcb = tcb_free;
     if (tcb == NULL) {
         br_hal_irq_restore(key);
         return BR_ERR_NOMEM;
     }
-    tcb->name        = name;
+    tcb_free = tcb->next;
+
+    tcb->name        = attr->name;
     tcb->entry       = entry;
     tcb->arg         = arg;
-    tcb->priority    = priority;
+    tcb->priority    = attr->priority;
+    tcb->base_priority = attr->priority;
     tcb->stack_base  = stack;
     tcb->stack_size  = stack_size;
-    tcb->wake_time   = 0;
-    tcb->rr_remaining = 0;
+    tcb->timeout.child   = NULL;
+    tcb->timeout.sibling = NULL;
+    tcb->timeout.prev    = NULL;
+    tcb->timer_slack = br_us_to_ticks(attr->timer_slack);
+    tcb->wait_queue  = NULL;
+    tcb->slice_end   = 0;
+    tcb->time_slice  = br_us_to_ticks(attr->time_slice != 0
+                                      ? attr->time_slice
+                                      : CONFIG_RR_TIME_SLICE_US);
+    tcb->policy      = (uint8_t)attr->policy;
+    tcb->held_mutexes = NULL;
+    tcb->blocked_on  = NULL;
     tcb->next        = NULL;
+#if CONFIG_SCHED_EDF
+    tcb->sched_class  = attr->sched_class;
+    tcb->rel_deadline = 0;
+    tcb->period       = 0;
+    tcb->release      = 0;
+    tcb->abs_deadline = 0;
+    if (attr->sched_class == BR_SCHED_EDF) {
+        /* First job is released now */
+        tcb->priority     = CONFIG_SCHED_EDF_PRIO;
+        tcb->base_priority = tcb->priority;
+        tcb->rel_deadline = br_us_to_ticks(attr->deadline);
+        tcb->period       = br_us_to_ticks(attr->period);
+        tcb->release      = br_hal_timer_get_ticks();
+        tcb->abs_deadline = tcb->release + tcb->rel_deadline;
+    }
+#endif
+#if CONFIG_SCHED_BUDGET
+    tcb->budget      = attr->budget;
+    tcb->exec_start  = 0;
+#endif
+#if CONFIG_TASK_STATS
+    tcb->stats.runtime     = 0;
+    tcb->stats.switches    = 0;
+    tcb->stats.preemptions = 0;
+    tcb->stats.voluntary   = 0;
+    tcb->run_start   = 0;
+    tcb->yielded     = false;
+#endif
+#if CONFIG_SMP
+    tcb->cpu         = (uint8_t)br_sched_select_cpu();
+#endif
 
     /* Place canary at the bottom of the stack (lowest address) */
     tcb->stack_canary = (uint32_t *)stack;
@@ -106,6 +272,12 @@ br_err_t br_task_create(br_tid_t *tid,
 
     void *stack_top = (uint8_t *)stack + stack_size;
     tcb->sp = br_hal_stack_init(stack_top, entry, arg);
+    if (tcb->sp == NULL) {
+        tcb->next = tcb_free;
+        tcb_free  = tcb;
+        br_hal_irq_restore(key);
+        return BR_ERR_NOMEM;
+    }
 
     if (tid != NULL) {
         *tid = tcb->id;
@@ -119,24 +291,16 @@ br_err_t br_task_create(br_tid_t *tid,
 
 br_err_t br_task_suspend(br_tid_t tid)
 {
-    if (tid >= CONFIG_MAX_TASKS) {
-        return BR_ERR_INVALID;
-    }
-
     uint32_t key = br_hal_irq_disable();
 
-    br_tcb_t *tcb = &tcb_pool[tid];
+    br_tcb_t *tcb = tcb_lookup(tid);
 
-    if (tcb->state == BR_TASK_INACTIVE) {
+    if (tcb == NULL) {
         br_hal_irq_restore(key);
         return BR_ERR_INVALID;
     }
 
-    if (tcb->state == BR_TASK_READY) {
-        br_sched_unready(tcb);
-    }
-
-    tcb->state = BR_TASK_SUSPENDED;
+    br_sched_suspend(tcb);
 
     br_hal_irq_restore(key);
 
@@ -149,13 +313,9 @@ br_err_t br_task_suspend(br_tid_t tid)
 
 br_err_t br_task_resume(br_tid_t tid)
 {
-    if (tid >= CONFIG_MAX_TASKS) {
-        return BR_ERR_INVALID;
-    }
-
-    br_tcb_t *tcb = &tcb_pool[tid];
+    br_tcb_t *tcb = tcb_lookup(tid);
 
-    if (tcb->state == BR_TASK_INACTIVE || tcb->state != BR_TASK_SUSPENDED) {
+    if (tcb == NULL || tcb->state != BR_TASK_SUSPENDED) {
         return BR_ERR_INVALID;
     }
 
@@ -167,48 +327,115 @@ br_err_t br_task_resume(br_tid_t tid)
 
 br_err_t br_task_delete(br_tid_t tid)
 {
-    if (tid >= CONFIG_MAX_TASKS) {
-        return BR_ERR_INVALID;
-    }
-
     uint32_t key = br_hal_irq_disable();
 
-    br_tcb_t *tcb = &tcb_pool[tid];
+    br_tcb_t *tcb = tcb_lookup(tid);
 
-    /* Cannot delete inactive task */
-    if (tcb->state == BR_TASK_INACTIVE) {
+    /* Cannot delete inactive task, or through a stale ID */
+    if (tcb == NULL) {
         br_hal_irq_restore(key);
         return BR_ERR_INVALID;
     }
 
-    /* Cannot delete currently running task (use br_task_yield + delete from another task) */
-    if (tcb == br_sched_current()) {
+    /* Cannot delete a running task (use br_task_yield + delete from another task) */
+    if (br_sched_task_on_cpu(tcb)) {
         br_hal_irq_restore(key);
         return BR_ERR_INVALID;
     }
 
     if (tcb->state == BR_TASK_READY) {
         br_sched_unready(tcb);
-    } else if (tcb->state == BR_TASK_BLOCKED) {
-        br_time_sleep_list_remove(tcb);
+    }
+    /* Blocked, or suspended while blocked */
+    br_time_timeout_remove(tcb);
+    if (tcb->wait_queue != NULL) {
+        br_ipc_abort_wait(tcb);
     }
 
-    /* Clear TCB and mark as inactive (returns slot to pool) */
+    /* Clear TCB, mark as inactive and return the slot to the pool under
+     * the next generation of its ID */
     tcb->state = BR_TASK_INACTIVE;
+    tcb->id = (br_tid_t)(tcb->id + (1U << TID_INDEX_BITS));
     tcb->name = NULL;
     tcb->entry = NULL;
     tcb->arg = NULL;
     tcb->stack_base = NULL;
     tcb->stack_size = 0;
     tcb->stack_canary = NULL;
+    br_hal_stack_release(tcb->sp);
     tcb->sp = NULL;
-    tcb->next = NULL;
+    tcb->next = tcb_free;
+    tcb_free = tcb;
 
     br_hal_irq_restore(key);
 
     return BR_OK;
 }
 
+br_err_t br_task_wait_next_period(void)
+{
+#if CONFIG_SCHED_EDF
+    if (br_hal_in_isr()) {
+        return BR_ERR_ISR;
+    }
+
+    br_tcb_t *cur = br_sched_current();
+    if (cur->sched_class != BR_SCHED_EDF || cur->period == 0) {
+        return BR_ERR_INVALID;
+    }
+
+    /* Not queued while running, so the sort key may change here */
+    uint32_t key = br_hal_irq_disable();
+    cur->release     += cur->period;
+    cur->abs_deadline = cur->release + cur->rel_deadline;
+    br_tick_t now     = br_hal_timer_get_ticks();
+    br_hal_irq_restore(key);
+
+    if (cur->release > now) {
+        br_time_sleep_until(cur->release, 0);
+        return BR_OK;
+    }
+
+    /* Overrun: the next job is already due.  Run it at once, behind
+     * any task whose deadline is now earlier. */
+    br_task_yield();
+    return BR_ERR_TIMEOUT;
+#else
+    return BR_ERR_INVALID;
+#endif
+}
+
+br_err_t br_task_get_stats(br_tid_t tid, br_task_stats_t *stats)
+{
+#if CONFIG_TASK_STATS
+    if (stats == NULL) {
+        return BR_ERR_INVALID;
+    }
+
+    uint32_t key = br_hal_irq_disable();
+
+    br_tcb_t *tcb = tcb_lookup(tid);
+
+    if (tcb == NULL) {
+        br_hal_irq_restore(key);
+        return BR_ERR_INVALID;
+    }
+
+    *stats = tcb->stats;
+    if (br_sched_task_on_cpu(tcb)) {
+        stats->runtime += br_hal_timer_get_ticks() - tcb->run_start;
+    }
+    stats->runtime = br_ticks_to_us(stats->runtime);
+
+    br_hal_irq_restore(key);
+    return BR_OK;
+#else
+    (void)tid;
+    (void)stats;
+    return BR_ERR_INVALID;
+#endif
+}
+
 br_tid_t br_task_self(void)
 {
     br_tcb_t *cur = br_sched_current();
@@ -15,49 +15,268 @@
 
 #include "bedrock/bedrock.h"
 
+#if CONFIG_PM && CONFIG_SMP
+#error "CONFIG_PM is not supported with CONFIG_SMP yet"
+#endif
+
 extern void     br_sched_ready(br_tcb_t *tcb);
 extern void     br_sched_unready(br_tcb_t *tcb);
 extern void     br_sched_reschedule(void);
 extern br_tcb_t *br_sched_current(void);
+extern void     br_ipc_abort_wait(br_tcb_t *tcb);
+#if !CONFIG_SMP
+extern br_tick_t br_sched_next_event(void);
+#endif
+
+/*
+ * Timeout heap -- a pairing heap of the sleep and timed-wait deadlines of
+ * all tasks, earliest at the root.  Each TCB carries its own entry, apart
+ * from the next link its ready or wait queue uses.  Insertion is O(1);
+ * removing the root, or cancelling an entry, cuts it out in O(1) and
+ * pairs up its children, O(log n) amortized.  A cancelled entry is
+ * nearly always a leaf, which has none.
+ *
+ * An entry may expire anywhere from its earliest time to its deadline
+ * (earliest + slack).  The heap is ordered by deadline and the alarm set
+ * for the root's; when it fires, entries keep being expired from the
+ * root on as long as their earliest time has passed, so timeouts whose
+ * windows overlap share one interrupt.
+ */
+static br_timeout_t *timeout_heap;
 
-/* Sleep list -- sorted by wake_time (ascending) */
-static br_tcb_t *sleep_list;
+#define TIMEOUT_TCB(t)  ((br_tcb_t *)((uint8_t *)(t) - offsetof(br_tcb_t, timeout)))
 
-void br_time_sleep_list_insert(br_tcb_t *tcb)
+/* Link two heaps, the later root becoming the first child of the other */
+static br_timeout_t *heap_meld(br_timeout_t *a, br_timeout_t *b)
 {
-    br_tcb_t **pp = &sleep_list;
-    while (*pp != NULL && (*pp)->wake_time <= tcb->wake_time) {
-        pp = &((*pp)->next);
+    if (a == NULL) {
+        return b;
+    }
+    if (b == NULL) {
+        return a;
+    }
+    if (b->deadline < a->deadline) {
+        br_timeout_t *t = a;
+        a = b;
+        b = t;
+    }
+    b->prev    = a;
+    b->sibling = a->child;
+    if (a->child != NULL) {
+        a->child->prev = b;
     }
-    tcb->next = *pp;
-    *pp = tcb;
+    a->child = b;
+    return a;
 }
 
-void br_time_sleep_list_remove(br_tcb_t *tcb)
+/* Two-pass pairing: meld a list of siblings into one heap */
+static br_timeout_t *heap_merge_pairs(br_timeout_t *first)
 {
-    br_tcb_t **pp = &sleep_list;
-    while (*pp != NULL) {
-        if (*pp == tcb) {
-            *pp = tcb->next;
-            tcb->next = NULL;
-            break;
+    br_timeout_t *pairs = NULL;
+
+    /* Left to right, meld neighbours; stack the results */
+    while (first != NULL) {
+        br_timeout_t *a = first;
+        br_timeout_t *b = a->sibling;
+        first = b != NULL ? b->sibling : NULL;
+
+        a->sibling = NULL;
+        a->prev    = NULL;
+        if (b != NULL) {
+            b->sibling = NULL;
+            b->prev    = NULL;
+        }
+        br_timeout_t *m = heap_meld(a, b);
+        m->sibling = pairs;
+        pairs = m;
+    }
+
+    /* Right to left, meld the pairs into one */
+    br_timeout_t *root = NULL;
+    while (pairs != NULL) {
+        br_timeout_t *next = pairs->sibling;
+        pairs->sibling = NULL;
+        root = heap_meld(root, pairs);
+        pairs = next;
+    }
+    return root;
+}
+
+static bool heap_queued(const br_timeout_t *t)
+{
+    return t == timeout_heap || t->prev != NULL;
+}
+
+static void heap_remove(br_timeout_t *t)
+{
+    if (t == timeout_heap) {
+        timeout_heap = heap_merge_pairs(t->child);
+    } else {
+        if (t->prev->child == t) {
+            t->prev->child = t->sibling;
+        } else {
+            t->prev->sibling = t->sibling;
         }
-        pp = &((*pp)->next);
+        if (t->sibling != NULL) {
+            t->sibling->prev = t->prev;
+        }
+        timeout_heap = heap_meld(timeout_heap, heap_merge_pairs(t->child));
+    }
+    t->child   = NULL;
+    t->sibling = NULL;
+    t->prev    = NULL;
+}
+
+/*
+ * The earliest pending event: the root of the timeout heap or, on
+ * uniprocessor builds, the running task's next scheduler event (budget
+ * exhaustion, end of a contended time slice).  IRQs disabled.
+ */
+static br_tick_t next_event(void)
+{
+    br_tick_t next = timeout_heap != NULL ? timeout_heap->deadline
+                                          : BR_TICK_INFINITE;
+#if !CONFIG_SMP
+    br_tick_t sched_event = br_sched_next_event();
+    if (sched_event < next) {
+        next = sched_event;
     }
+#endif
+    return next;
 }
 
-static void reprogram_alarm(void)
+/*
+ * Program the one-shot alarm for the earliest pending event.
+ * Must be called with IRQs disabled.
+ */
+void br_time_reprogram_alarm(void)
 {
-    if (sleep_list != NULL) {
-        br_hal_timer_set_alarm(sleep_list->wake_time);
+    br_tick_t next = next_event();
+
+    if (next != BR_TICK_INFINITE) {
+        br_hal_timer_set_alarm(next);
     } else {
         br_hal_timer_cancel_alarm();
     }
 }
 
+/*
+ * Queue t to expire between earliest and earliest + slack; the caller
+ * re-arms the alarm
+ */
+static void timeout_queue(br_timeout_t *t, br_tick_t earliest,
+                          br_tick_t slack)
+{
+    t->earliest = earliest;
+    /* BR_TICK_INFINITE would mean no alarm at all */
+    t->deadline = slack < BR_TICK_INFINITE - earliest ? earliest + slack
+                                                      : BR_TICK_INFINITE - 1U;
+    t->child    = NULL;
+    t->sibling  = NULL;
+    t->prev     = NULL;
+    timeout_heap = heap_meld(timeout_heap, t);
+}
+
+/* Queue t, re-arming the alarm if it now has the earliest deadline */
+static void timeout_add(br_timeout_t *t, br_tick_t earliest, br_tick_t slack)
+{
+    timeout_queue(t, earliest, slack);
+
+    if (timeout_heap == t) {
+        br_time_reprogram_alarm();
+    }
+}
+
+/* Dequeue t if queued, re-arming the alarm if it was the earliest */
+static void timeout_remove(br_timeout_t *t)
+{
+    if (!heap_queued(t)) {
+        return;
+    }
+    bool was_first = t == timeout_heap;
+    heap_remove(t);
+
+    if (was_first) {
+        br_time_reprogram_alarm();
+    }
+}
+
+/* A task's sleep or timed wait ran out */
+static void tcb_timeout_expire(br_timeout_t *t)
+{
+    br_tcb_t *tcb = TIMEOUT_TCB(t);
+
+    tcb->wait_result = BR_ERR_TIMEOUT;
+    if (tcb->wait_queue != NULL) {
+        br_ipc_abort_wait(tcb);
+    }
+    br_sched_ready(tcb);
+}
+
+/*
+ * Wake tcb with BR_ERR_TIMEOUT once the given time has passed, at most
+ * slack later, unless the timeout is removed first.  Re-arms the alarm
+ * if this is now the earliest deadline.  Must be called with IRQs
+ * disabled.
+ */
+void br_time_timeout_add(br_tcb_t *tcb, br_tick_t deadline, br_tick_t slack)
+{
+    tcb->timeout.expire = tcb_timeout_expire;
+    timeout_add(&tcb->timeout, deadline, slack);
+}
+
+/*
+ * Cancel tcb's timeout, if it has one.  Re-arms the alarm if it was the
+ * earliest deadline.  Must be called with IRQs disabled.
+ */
+void br_time_timeout_remove(br_tcb_t *tcb)
+{
+    timeout_remove(&tcb->timeout);
+}
+
+/* The tick `us` microseconds from now, short of BR_TICK_INFINITE */
+br_tick_t br_time_deadline(br_time_t us)
+{
+    br_tick_t now   = br_hal_timer_get_ticks();
+    br_tick_t ticks = br_us_to_ticks(us);
+
+    return ticks < BR_TICK_INFINITE - now ? now + ticks : BR_TICK_INFINITE - 1U;
+}
+
+/*
+ * Block the calling task until the given tick, at most slack later;
+ * yield instead if that tick has come.
+ */
+void br_time_sleep_until(br_tick_t until, br_tick_t slack)
+{
+    uint32_t key = br_hal_irq_disable();
+
+    if (until <= br_hal_timer_get_ticks()) {
+        br_hal_irq_restore(key);
+        br_task_yield();
+        return;
+    }
+
+    br_tcb_t *tcb = br_sched_current();
+    tcb->state = BR_TASK_BLOCKED;
+    br_time_timeout_add(tcb, until, slack);
+
+    br_hal_irq_restore(key);
+    br_sched_reschedule();
+}
+
 br_time_t br_uptime_us(void)
 {
-    return br_hal_timer_get_us();
+    return br_ticks_to_us(br_hal_timer_get_ticks());
+}
+
+void br_sleep_us_slack(br_time_t us, br_time_t slack)
+{
+    if (us == 0) {
+        br_task_yield();
+        return;
+    }
+    br_time_sleep_until(br_time_deadline(us), br_us_to_ticks(slack));
 }
 
 void br_sleep_us(br_time_t us)
@@ -66,33 +285,456 @@ void br_sleep_us(br_time_t us)
         br_task_yield();
         return;
     }
+    br_time_sleep_until(br_time_deadline(us), br_sched_current()->timer_slack);
+}
 
-    uint32_t key = br_hal_irq_disable();
+void br_sleep_until(br_time_t abs_us)
+{
+    br_time_sleep_until(br_us_to_ticks(abs_us),
+                        br_sched_current()->timer_slack);
+}
 
-    br_tcb_t *tcb = br_sched_current();
-    tcb->state     = BR_TASK_BLOCKED;
-    tcb->wake_time = br_hal_timer_get_us() + us;
+br_err_t br_periodic_init(br_periodic_t *p, br_time_t period)
+{
+    if (p == NULL || period == 0 || period == BR_TIME_INFINITE) {
+        return BR_ERR_INVALID;
+    }
 
-    br_time_sleep_list_insert(tcb);
-    reprogram_alarm();
+    p->period     = period;
+    p->release    = br_uptime_us();
+    p->releases   = 0;
+    p->overruns   = 0;
+    p->jitter_min = BR_TIME_INFINITE;
+    p->jitter_max = 0;
+    for (int i = 0; i < BR_PERIODIC_HIST_BINS; i++) {
+        p->jitter_hist[i] = 0;
+    }
+    return BR_OK;
+}
 
-    br_hal_irq_restore(key);
-    br_sched_reschedule();
+br_err_t br_periodic_wait(br_periodic_t *p)
+{
+    if (p == NULL || p->period == 0) {
+        return BR_ERR_INVALID;
+    }
+    if (br_hal_in_isr()) {
+        return BR_ERR_ISR;
+    }
+
+    br_time_t next = p->release + p->period;
+    br_time_t now  = br_uptime_us();
+
+    if (next <= now) {
+        p->overruns++;
+        p->release = next + (now - next) / p->period * p->period;
+        return BR_ERR_TIMEOUT;
+    }
+
+    p->release = next;
+    br_sleep_until(next);
+
+    br_time_t jitter = br_uptime_us() - next;
+    uint32_t bin = 0;
+    if (jitter != 0) {
+        bin = jitter >= (1U << (BR_PERIODIC_HIST_BINS - 2))
+              ? BR_PERIODIC_HIST_BINS - 1
+              : 32U - (uint32_t)__builtin_clz((uint32_t)jitter);
+    }
+    p->jitter_hist[bin]++;
+    if (jitter < p->jitter_min) {
+        p->jitter_min = jitter;
+    }
+    if (jitter > p->jitter_max) {
+        p->jitter_max = jitter;
+    }
+    p->releases++;
+    return BR_OK;
 }
 
 void br_time_alarm_handler(void)
 {
-    br_time_t now = br_hal_timer_get_us();
+    uint32_t key = br_hal_irq_disable();
+    br_tick_t now = br_hal_timer_get_ticks();
 
-    while (sleep_list != NULL && sleep_list->wake_time <= now) {
-        br_tcb_t *tcb = sleep_list;
-        sleep_list = tcb->next;
-        tcb->next = NULL;
-        tcb->wake_time = 0;
-        tcb->wait_result = BR_ERR_TIMEOUT;
-        br_sched_ready(tcb);
+    while (timeout_heap != NULL && timeout_heap->earliest <= now) {
+        br_timeout_t *t = timeout_heap;
+        heap_remove(t);
+        t->expire(t);
     }
 
-    reprogram_alarm();
+    br_time_reprogram_alarm();
+    br_hal_irq_restore(key);
+
+    /* In ISR context this only flags the reschedule for interrupt exit */
     br_sched_reschedule();
 }
+
+#if CONFIG_TIMERS
+
+/*
+ * Software timers.  A running timer is an entry in the timeout heap like
+ * any task timeout, so timers need no alarm or tick of their own.  When
+ * one expires, a BR_TIMER_ISR timer is called back right away from the
+ * alarm handler; any other is appended to the pending list, which the
+ * timer service task drains in expiry order.
+ */
+#define TIMEOUT_TIMER(t)  ((br_timer_t *)((uint8_t *)(t) - offsetof(br_timer_t, timeout)))
+
+static uint8_t     timer_service_stack[CONFIG_TIMER_SERVICE_STACK_SIZE];
+static br_tcb_t   *timer_service;        /* Set once the task first runs */
+static bool        timer_service_idle;   /* Blocked for want of work */
+static br_timer_t *pending_head;
+static br_timer_t *pending_tail;
+
+static void pending_remove(br_timer_t *timer)
+{
+    br_timer_t *prev = NULL;
+    br_timer_t *cur  = pending_head;
+
+    while (cur != timer) {
+        prev = cur;
+        cur  = cur->next_pending;
+    }
+    if (prev == NULL) {
+        pending_head = timer->next_pending;
+    } else {
+        prev->next_pending = timer->next_pending;
+    }
+    if (pending_tail == timer) {
+        pending_tail = prev;
+    }
+    timer->next_pending = NULL;
+    timer->pending      = false;
+}
+
+static void timer_expire(br_timeout_t *t)
+{
+    br_timer_t *timer = TIMEOUT_TIMER(t);
+
+    /* Rearm before the callback, which may stop or restart the timer.
+     * Periods missed altogether (a long critical section) are skipped
+     * rather than fired back to back. */
+    if (timer->period != 0) {
+        br_tick_t now  = br_hal_timer_get_ticks();
+        br_tick_t next = t->earliest + timer->period;
+        if (next <= now) {
+            next += (now - next) / timer->period * timer->period +
+                    timer->period;
+        }
+        timeout_queue(t, next, 0);
+    }
+
+    if (timer->flags & BR_TIMER_ISR) {
+        timer->callback(timer, timer->arg);
+        return;
+    }
+
+    /* A callback still waiting for the service task runs only once */
+    if (timer->pending) {
+        return;
+    }
+    timer->pending      = true;
+    timer->next_pending = NULL;
+    if (pending_tail != NULL) {
+        pending_tail->next_pending = timer;
+    } else {
+        pending_head = timer;
+    }
+    pending_tail = timer;
+
+    if (timer_service_idle) {
+        timer_service_idle = false;
+        br_sched_ready(timer_service);
+    }
+}
+
+static void timer_service_entry(void *arg)
+{
+    (void)arg;
+
+    timer_service = br_sched_current();
+
+    while (1) {
+        uint32_t key = br_hal_irq_disable();
+
+        br_timer_t *timer = pending_head;
+        if (timer == NULL) {
+            timer_service_idle = true;
+            timer_service->state = BR_TASK_BLOCKED;
+            br_hal_irq_restore(key);
+            br_sched_reschedule();
+            continue;
+        }
+        pending_remove(timer);
+        br_timer_fn_t callback = timer->callback;
+        void *cb_arg = timer->arg;
+
+        br_hal_irq_restore(key);
+
+        callback(timer, cb_arg);
+    }
+}
+
+/* Called from br_kernel_init() */
+void br_timer_service_init(void)
+{
+    timer_service      = NULL;
+    timer_service_idle = false;
+    pending_head       = NULL;
+    pending_tail       = NULL;
+
+    br_err_t err = br_task_create(NULL, "timer", timer_service_entry, NULL,
+                                  CONFIG_TIMER_SERVICE_PRIO,
+                                  timer_service_stack,
+                                  sizeof(timer_service_stack));
+    if (err != BR_OK) {
+        while (1) { } /* Fatal: cannot create the timer service task */
+    }
+}
+
+br_err_t br_timer_init(br_timer_t *timer, br_timer_fn_t callback, void *arg,
+                       uint8_t flags)
+{
+    if (timer == NULL || callback == NULL || (flags & ~BR_TIMER_ISR) != 0) {
+        return BR_ERR_INVALID;
+    }
+
+    timer->timeout.child   = NULL;
+    timer->timeout.sibling = NULL;
+    timer->timeout.prev    = NULL;
+    timer->timeout.expire  = timer_expire;
+    timer->callback        = callback;
+    timer->arg             = arg;
+    timer->period          = 0;
+    timer->flags           = flags;
+    timer->pending         = false;
+    timer->next_pending    = NULL;
+    return BR_OK;
+}
+
+br_err_t br_timer_start(br_timer_t *timer, br_time_t delay, br_time_t period)
+{
+    br_tick_t period_ticks = br_us_to_ticks(period);
+
+    if (timer == NULL || timer->callback == NULL ||
+        delay == BR_TIME_INFINITE || period_ticks == BR_TICK_INFINITE) {
+        return BR_ERR_INVALID;
+    }
+
+    uint32_t key = br_hal_irq_disable();
+
+    if (timer->pending) {
+        pending_remove(timer);
+    }
+    if (heap_queued(&timer->timeout)) {
+        heap_remove(&timer->timeout);
+    }
+    timer->period = period_ticks;
+    timeout_queue(&timer->timeout, br_time_deadline(delay), 0);
+    br_time_reprogram_alarm();
+
+    br_hal_irq_restore(key);
+    return BR_OK;
+}
+
+br_err_t br_timer_stop(br_timer_t *timer)
+{
+    if (timer == NULL) {
+        return BR_ERR_INVALID;
+    }
+
+    uint32_t key = br_hal_irq_disable();
+
+    if (timer->pending) {
+        pending_remove(timer);
+    }
+    timeout_remove(&timer->timeout);
+
+    br_hal_irq_restore(key);
+    return BR_OK;
+}
+
+#endif /* CONFIG_TIMERS */
+
+/*
+ * Code-region probes -- a static table of cycle statistics, one entry per
+ * probe ID.  The begin timestamp lives in the caller's frame (see
+ * BR_PROBE_BEGIN()), so the only shared state is the entry, updated with
+ * interrupts disabled.
+ */
+#if CONFIG_PROBES
+static br_probe_t probes[CONFIG_PROBE_COUNT];
+#endif
+
+void br_probe_record(uint32_t id, br_cycles_t cycles)
+{
+#if CONFIG_PROBES
+    if (id >= CONFIG_PROBE_COUNT) {
+        return;
+    }
+
+    uint32_t bin = 0;
+    if (cycles != 0) {
+        bin = cycles >= (1UL << (BR_PROBE_HIST_BINS - 2))
+              ? BR_PROBE_HIST_BINS - 1
+              : 32U - (uint32_t)__builtin_clz(cycles);
+    }
+
+    uint32_t key = br_hal_irq_disable();
+
+    br_probe_t *p = &probes[id];
+    if (p->count == 0 || cycles < p->min) {
+        p->min = cycles;
+    }
+    if (cycles > p->max) {
+        p->max = cycles;
+    }
+    p->count++;
+    p->total += cycles;
+    p->hist[bin]++;
+
+    br_hal_irq_restore(key);
+#else
+    (void)id;
+    (void)cycles;
+#endif
+}
+
+br_err_t br_probe_read(uint32_t id, br_probe_t *out)
+{
+#if CONFIG_PROBES
+    if (id >= CONFIG_PROBE_COUNT || out == NULL) {
+        return BR_ERR_INVALID;
+    }
+
+    uint32_t key = br_hal_irq_disable();
+    *out = probes[id];
+    br_hal_irq_restore(key);
+    return BR_OK;
+#else
+    (void)id;
+    (void)out;
+    return BR_ERR_INVALID;
+#endif
+}
+
+br_err_t br_probe_reset(uint32_t id)
+{
+#if CONFIG_PROBES
+    if (id >= CONFIG_PROBE_COUNT) {
+        return BR_ERR_INVALID;
+    }
+
+    uint32_t key = br_hal_irq_disable();
+
+    br_probe_t *p = &probes[id];
+    p->count = 0;
+    p->min   = 0;
+    p->max   = 0;
+    p->total = 0;
+    for (int i = 0; i < BR_PROBE_HIST_BINS; i++) {
+        p->hist[i] = 0;
+    }
+
+    br_hal_irq_restore(key);
+    return BR_OK;
+#else
+    (void)id;
+    return BR_ERR_INVALID;
+#endif
+}
+
+/*
+ * Idle governor -- sleep the CPU in the deepest power state that can be
+ * entered and left again before the next event, and move the alarm
+ * forward by the state's exit latency so the CPU is running again when
+ * the event is due.  The HAL keeps the time base right across the
+ * sleep.  Called by the idle task.
+ */
+#if CONFIG_PM
+static struct {
+    uint32_t  entries;
+    br_tick_t residency;
+} pm_stats[BR_HAL_POWER_STATES_MAX];
+
+static uint32_t pm_state_count(const br_power_state_t **states)
+{
+    uint32_t count;
+    *states = br_hal_power_states(&count);
+    return count < BR_HAL_POWER_STATES_MAX ? count : BR_HAL_POWER_STATES_MAX;
+}
+
+void br_time_idle(void)
+{
+    const br_power_state_t *states;
+    uint32_t count = pm_state_count(&states);
+
+    uint32_t key = br_hal_irq_disable();
+    br_tick_t now  = br_hal_timer_get_ticks();
+    br_tick_t next = next_event();
+    br_tick_t left = next > now ? next - now : 0;
+
+    uint32_t state = 0;
+    for (uint32_t i = count; i-- > 1; ) {
+        br_tick_t cost = br_us_to_ticks(states[i].entry_latency +
+                                        states[i].exit_latency);
+        if (next == BR_TICK_INFINITE || cost <= left) {
+            state = i;
+            break;
+        }
+    }
+
+    /* State 0 is taken even when leaving it outlasts the time left; then
+     * wake at once rather than at a time already past (or wrapped) */
+    br_tick_t exit = br_us_to_ticks(states[state].exit_latency);
+    bool early = exit != 0 && next != BR_TICK_INFINITE;
+    if (early) {
+        br_hal_timer_set_alarm(exit < left ? next - exit : now);
+    }
+
+    br_hal_power_enter(state);
+
+    pm_stats[state].entries++;
+    pm_stats[state].residency += br_hal_timer_get_ticks() - now;
+
+    /* Woken by something else, the early alarm is still set */
+    if (early) {
+        br_time_reprogram_alarm();
+    }
+    br_hal_irq_restore(key);
+}
+#endif /* CONFIG_PM */
+
+uint32_t br_power_state_count(void)
+{
+#if CONFIG_PM
+    const br_power_state_t *states;
+    return pm_state_count(&states);
+#else
+    return 0;
+#endif
+}
+
+br_err_t br_power_get_stats(uint32_t state, br_power_stats_t *stats)
+{
+#if CONFIG_PM
+    const br_power_state_t *states;
+    if (state >= pm_state_count(&states) || stats == NULL) {
+        return BR_ERR_INVALID;
+    }
+
+    stats->name          = states[state].name;
+    stats->entry_latency = states[state].entry_latency;
+    stats->exit_latency  = states[state].exit_latency;
+
+    uint32_t key = br_hal_irq_disable();
+    stats->entries   = pm_stats[state].entries;
+    stats->residency = br_ticks_to_us(pm_stats[state].residency);
+    br_hal_irq_restore(key);
+    return BR_OK;
+#else
+    (void)state;
+    (void)stats;
+    return BR_ERR_INVALID;
+#endif
+}